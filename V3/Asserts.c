@@ -9,6 +9,10 @@
 #include "Heap.h"
 #include "Processor.h"
 #include "OperatingSystem.h"
+#include "Events.h"
+#include "Log.h"
+#include "FlightRecorder.h"
+#include "AssertsFile.h"
 
 extern MEMORYCELL mainMemory[];
 extern int registerPC_CPU; // Program counter
@@ -20,40 +24,6 @@ extern BUSDATACELL registerMBR_CPU; // Memory Buffer Register
 extern int executingProcessID; // Executing process PID
 extern char *InstructionNames[]; // Names of processor instructions
 
-char *elements[]={
-	"RMEM_OP",	// Relative MEMory OPeration code
-	"RMEM_O1",	// Relative MEMory Operand 1
-	"RMEM_O2",	// Relative MEMory Operand 2
-	"AMEM_OP",	// Absolute MEMory OPeration code
-	"AMEM_O1",	// Absolute MEMory Operand 1
-	"AMEM_O2",	// Absolute MEMory Operand 2
-	"PC",		// Program Counter
-	"ACC",		// ACCumulator
-	"IR_OP",	// Instruction Register OPeration code
-	"IR_O1",	// Instruction Register Operand 1
-	"IR_O2",	// Instruction Register Operand 2
-	"PSW",		// Processor State Word
-	"MAR",		// Memory Address Register
-	"MBR_OP",	// Memory Buffer Register OPeration code
-	"MBR_O1",	// Memory Buffer Register Operand 1
-	"MBR_O2",	// Memory Buffer Register Operand 2
-	"MMU_BS",	// Memory Management Unit BaSe
-	"MMU_LM",	// Memory Management Unit LiMit
-	"MMU_MAR",	// Memory Management Unit Memory Address Register
-	"MMEM_MAR",	// Main MEMory Memory Address Register
-	"MMBR_OP",	// Main Memory Buffer Register OPeration code
-	"MMBR_O1",	// Main Memory Buffer Register Operand 1
-	"MMBR_O2",	// Main Memory Buffer Register Operand 2
-	"XPID",		// eXecuting PID
-	"RMEM",	// Relative MEMory
-	"AMEM",	// Absolute MEMory
-	"MBR",	// Memory Buffer Register
-	"MMBR",	// Main Memory Buffer Register
-	"PCB_ST",	// Process Table item state field
-	"PCB_PC",	// Process Table item copyOfPCRegister field
-	"PCB_PR",	// Process Table item priority field
-	NULL};
-
 ASSERT_DATA * asserts;
 int MAX_ASSERTS=500; // Default number of asserts
 
@@ -63,56 +33,57 @@ int numOfElementsInAssertsQueue=0;
 
 // All time asserts list is at the end of assersQueue in reverse order
 int beginOfAllTimeAsserts;
+int endOfAllTimeAsserts;
 
-// prototype functions
-int Asserts_IsThereANewAssert(int);
-void Asserts_CheckOneAssert(int);
+// Binary asserts file (see AssertsFile.h): the asserts are read by the cursor as time goes by
+int assertsBinary=0;
+ASSERTSFILE_CURSOR assertsCursor;
 
-int GEN_ASSERTS=0;
-
-char ASSERTS_FILE[MAXIMUMLENGTH]="asserts";  // Default asserts file name
+// Set when the time of the first assert in assertsQueue has come
+int assertsCheckpoint=0;
 
-// Search assert element linearly into the array
-int elementNumber(char *cmp) {
- int n=0;
+// All time asserts on absolute memory cells are not in that list: they are chained
+// from the cell they watch and checked only after the cell has been written
+enum AssertsCellStates { CELL_UNWATCHED, CELL_WATCHED, CELL_WRITTEN };
+char assertsCellState[MAINMEMORYSIZE];
+int assertsOfCell[MAINMEMORYSIZE] = {[0 ... MAINMEMORYSIZE-1] = -1};
+int numberOfCellAsserts=0;
+int writtenCells[MAINMEMORYSIZE];
+int numberOfWrittenCells=0;
 
- while ((elements[n]!=NULL) && strcmp(cmp, elements[n]))
-   n++;
-
- if (elements[n]==NULL) return -1;
- else return n;
-	
-}
+// prototype functions
+int Asserts_IsThereANewAssert(SIMTIME);
+void Asserts_CheckOneAssert(ASSERT_DATA *);
+void Asserts_CheckAllTimeAssert(int);
+void Asserts_CheckFileAsserts(SIMTIME);
+int Asserts_LoadBinaryAsserts(ASSERTSFILE_HEADER *);
+int Asserts_ValidRecord(ASSERTSFILE_RECORD *);
+void Asserts_AddAllTimeAssert(int);
+void Asserts_ScheduleCheckpoint();
 
-void strcpySpaces(char *target, char *src, int nChars) {
-	int l, s, t;
+int GEN_ASSERTS=0;
 
-	l=strlen(src);
-	t=0;
-	for (s=0; (t<nChars-1) && (s<l); s++) {
-		if (src[s]!=' ' && src[s]!='\n' && src[s]!='\r')
-			target[t++]=src[s];
-	}
-	target[t]=0;
-}
+char ASSERTS_FILE[MAXIMUMLENGTH]="asserts";  // Default asserts file name
 
 int Asserts_LoadAsserts() {
 	// load asserts file into asserts array;
  ASSERT_DATA a;
+ ASSERTSFILE_HEADER header;
 
  char lineRead[MAXIMUMLENGTH];
  FILE *mf;
- char *time, *element, *value, *address;
- char svalue[E_SIZE];
- 
+ char *value;
 
  int lineNumber=0;;
  int numberAsserts=0;
  int rc;
- int en;
+
+ // A binary asserts file is not loaded, but read through a cursor while running
+ if (AssertsFile_Open(ASSERTS_FILE, &assertsCursor, &header)==0)
+	return Asserts_LoadBinaryAsserts(&header);
 
 // All time asserts list is at the end of assersQueue in reverse order
- beginOfAllTimeAsserts=MAX_ASSERTS;
+ beginOfAllTimeAsserts=endOfAllTimeAsserts=MAX_ASSERTS;
 
  mf=fopen(ASSERTS_FILE, "r");
  if (mf==NULL) {
@@ -131,79 +102,15 @@ int Asserts_LoadAsserts() {
     
    while (fgets(lineRead,MAXIMUMLENGTH, mf) != NULL && numberAsserts<MAX_ASSERTS) {
 	lineNumber++;	
-	// reading up to 4 items for assert
-	time=strtok(lineRead,",");
-    if (time==NULL){
- 		// printf("Illegal Assert in line %d of file %s\n",lineNumber,ASSERTS_FILE);
-		ComputerSystem_DebugMessage(84,POWERON,lineNumber,ASSERTS_FILE);
-		continue;
-	}
-	
-	if ((time[0]=='/') || (time[0]=='\n')|| (time[0]=='\r'))
-		continue; // Skip coments and empty lines
-
-	element=strtok(NULL,",");
-    if (element==NULL){
- 		// printf("Illegal Assert in line %d of file %s\n",lineNumber,ASSERTS_FILE);
-		ComputerSystem_DebugMessage(84,POWERON,lineNumber,ASSERTS_FILE);
+	value=NULL;
+	rc=AssertsFile_ParseLine(lineRead, &a, &value);
+	if (rc==ASSERTSFILE_SKIP)
 		continue;
-	}
-
-	value=strtok(NULL,",");
-    if (value==NULL){
+	if (rc>0) {
  		// printf("Illegal Assert in line %d of file %s\n",lineNumber,ASSERTS_FILE);
-		ComputerSystem_DebugMessage(84,POWERON,lineNumber,ASSERTS_FILE);
-		continue;
-	}
-    address=strtok(NULL,"\n");
-
- 	strcpySpaces(a.element, element,E_SIZE);
-	if (strcmp(time,"*")) {
-      rc=sscanf(time,"%d",&a.time);
-	  if (rc==0){
- 		// printf("Illegal time format in line %d of file %s\n",lineNumber,ASSERTS_FILE);
-		ComputerSystem_DebugMessage(82,POWERON,lineNumber,ASSERTS_FILE);
+		ComputerSystem_DebugMessage(rc,POWERON,lineNumber,ASSERTS_FILE,value);
 		continue;
-	  }
-	}
-    else a.time=-33; // All the instants of time.
-        
-	// If an Operation code read string (RMEM_OP, AMEM_OP,IR_OP, MBR_OP, MMBR_OP)
-	en=elementNumber(a.element);
-	if ((en==RMEM_OP) || (en==AMEM_OP) || (en==IR_OP) || (en==MBR_OP) || (en==MMBR_OP)) {
-		strcpySpaces(svalue, value,E_SIZE);
-		a.value=Processor_ToInstruction(svalue);
-		if (a.value<0)
-			rc=0;
-	}
-	else
-		rc=sscanf(value,"%d",&a.value);
-
-    if (rc==0){
- 			// printf("Illegal expected value format in line %d of file %s (%s)\n",lineNumber,ASSERTS_FILE,value);
-			ComputerSystem_DebugMessage(86,POWERON,lineNumber,ASSERTS_FILE, value);
-			continue;
-	}
-
-    // If memory cell we read address (RMEM_OP, RMEM_O1, RMEM_O2, AMEM_OP, AMEM_O1, AMEM_O2)
-	en=elementNumber(a.element);
-	if ((en==RMEM_OP) || (en==RMEM_O1) || (en==RMEM_O2) 
-		|| (en==AMEM_OP) || (en==AMEM_O1) || (en==AMEM_O2) 
-		|| (en==RMEM) || (en==AMEM)
-		|| (en==PCB_ST) || (en==PCB_PC) || (en==PCB_PR)) {
-		if (address==NULL){
- 			// printf("Illegal Assert in line %d of file %s\n",lineNumber,ASSERTS_FILE);
-			ComputerSystem_DebugMessage(84,POWERON,lineNumber,ASSERTS_FILE);
-			continue;
-		}
-		rc=sscanf(address,"%d",&a.address);
-        if (rc==0){
-	 		// printf("Illegal address format in line %d of file %s\n",lineNumber,ASSERTS_FILE);
-			ComputerSystem_DebugMessage(87,POWERON,lineNumber,ASSERTS_FILE);
-			continue;    
-	    }
 	}
-	else a.address=0;
 
 	asserts[numberAsserts]=a;
 
@@ -211,8 +118,7 @@ int Asserts_LoadAsserts() {
 		// add to asserts heap
 		Heap_add(numberAsserts,assertsQueue,QUEUE_ASSERTS,&numOfElementsInAssertsQueue,MAX_ASSERTS);
 	else
-		// add at the end and update starting point of all time asserts
-		assertsQueue[--beginOfAllTimeAsserts].info=numberAsserts;
+		Asserts_AddAllTimeAssert(numberAsserts);
 
 	numberAsserts++;
    }
@@ -225,254 +131,276 @@ int Asserts_LoadAsserts() {
 
    ComputerSystem_DebugMessage(82,POWERON,numberAsserts);
 
+   Asserts_ScheduleCheckpoint();
+
    return numberAsserts;
 }
 
+// All time asserts of a binary asserts file are loaded; the rest stay in the file
+int Asserts_LoadBinaryAsserts(ASSERTSFILE_HEADER *header) {
+	ASSERTSFILE_RECORD *record;
+	int numberAsserts=0;
+
+	assertsBinary=1;
+	ComputerSystem_DebugMessage(81, POWERON, ASSERTS_FILE, (int) header->numberOfAsserts);
+
+	asserts=(ASSERT_DATA *) malloc((header->numberOfAllTimeAsserts+1)*sizeof(ASSERT_DATA));
+	assertsQueue=(heapItem *) malloc((header->numberOfAllTimeAsserts+1)*sizeof(heapItem));
+	beginOfAllTimeAsserts=endOfAllTimeAsserts=header->numberOfAllTimeAsserts;
+
+	while ((record=AssertsFile_Peek(&assertsCursor))!=NULL && record->time==-33) {
+		AssertsFile_Next(&assertsCursor);
+		if (numberAsserts==header->numberOfAllTimeAsserts || !Asserts_ValidRecord(record))
+			continue;
+		asserts[numberAsserts].time=record->time;
+		asserts[numberAsserts].value=record->value;
+		asserts[numberAsserts].element=record->element;
+		asserts[numberAsserts].address=record->address;
+		asserts[numberAsserts].checked=0;
+		asserts[numberAsserts].nextInCell=-1;
+		Asserts_AddAllTimeAssert(numberAsserts++);
+	}
+
+	ComputerSystem_DebugMessage(82,POWERON,(int) header->numberOfAsserts);
+
+	Asserts_ScheduleCheckpoint();
+
+	return header->numberOfAsserts;
+}
+
+// A record of a binary file may not be trusted to have a known element or a right address
+int Asserts_ValidRecord(ASSERTSFILE_RECORD *record) {
+	if (record->element<0 || record->element>=NUMBEROFASSERTELEMENTS
+	 || !AssertsFile_ValidAddress(record->element, record->address)) {
+		ComputerSystem_DebugMessage(84,POWERON,record->lineNumber,ASSERTS_FILE);
+		return 0;
+	}
+	return 1;
+}
+
+// Asserts on absolute memory cells are chained from their cell, written as far as the
+// first check is concerned. The rest go at the end of assertsQueue
+void Asserts_AddAllTimeAssert(int na) {
+	int address=asserts[na].address;
+
+	if (elementWatch[asserts[na].element]==ASSERT_WATCHCELL && !GEN_ASSERTS) {
+		asserts[na].nextInCell=assertsOfCell[address];
+		assertsOfCell[address]=na;
+		assertsCellState[address]=CELL_WATCHED;
+		numberOfCellAsserts++;
+		Asserts_MemoryWritten(address);
+	}
+	else
+		// add at the end and update starting point of all time asserts
+		assertsQueue[--beginOfAllTimeAsserts].info=na;
+}
+
 
-void genAssertMsg(int time, char *ele, int realValue, int addr) {
-	int en;
+void genAssertMsg(SIMTIME time, int en, int realValue, int addr) {
 
-	printf("%d, %s",time, ele);
-	en=elementNumber(ele);
+	Log_Printf(ALL,"%lld, %s",time, elements[en]);
 	
-	if ((en==RMEM_OP) || (en==AMEM_OP) || (en==IR_OP) || (en==MBR_OP)) 
-	  	printf(", %s",InstructionNames[realValue]);
+	if (elementShownAsInstruction[en]) 
+	  	Log_Printf(ALL,", %s",InstructionNames[realValue]);
 	else
-		printf(", %d", realValue);
+		Log_Printf(ALL,", %d", realValue);
 	
-	if ((en==RMEM_OP) || (en==RMEM_O1) || (en==RMEM_O2)
-		 || (en==AMEM_OP) || (en==AMEM_O1) || (en==AMEM_O2) 
-		 || (en==RMEM) || (en==AMEM)
-		 || (en==PCB_ST) || (en==PCB_PC) || (en==PCB_PR))
-		printf(", %d", addr);
+	if (elementAddress[en]!=ASSERT_NOADDRESS)
+		Log_Printf(ALL,", %d", addr);
 	
-	printf("\n");
+	Log_Printf(ALL,"\n");
 }
 	
-void assertMsg(int time, char *ele, int expectedValue, int realValue, int addr) {
-	int en;
+void assertMsg(SIMTIME time, int en, int expectedValue, int realValue, int addr) {
 
 	if (GEN_ASSERTS) { 
-		genAssertMsg(time, ele, realValue,addr);
+		genAssertMsg(time, en, realValue,addr);
 		return;  // only generate, not checking
 	}	
 
 	// printf("Assert failed. Time: %d; Element: %s; ", time, ele);
-	ComputerSystem_DebugMessage(88,ERROR, time, ele);
-	en=elementNumber(ele);
+	ComputerSystem_DebugMessage(88,ERROR, time, elements[en]);
 	
-	if ((en==RMEM_OP) || (en==AMEM_OP) || (en==IR_OP) || (en==MBR_OP)) 
+	if (elementShownAsInstruction[en]) 
 	  	// printf("Expected: '%s'; Real: '%s'", expectedValue, realValue);
 	  	ComputerSystem_DebugMessage(89,ERROR, InstructionNames[expectedValue], InstructionNames[realValue]);
 	else
 		// printf("Expected: %d; Real: %d", expectedValue, realValue);
 		ComputerSystem_DebugMessage(90,ERROR, expectedValue, realValue);
 	
-	if ((en==RMEM_OP) || (en==RMEM_O1) || (en==RMEM_O2) || (en==AMEM_OP) || (en==AMEM_O1) || (en==AMEM_O2) || (en==RMEM) || (en==AMEM)) 
+	if (elementAddress[en]==ASSERT_MEMORYADDRESS) 
 		// printf("; Memory address: %d", addr);
 		ComputerSystem_DebugMessage(91,ERROR, addr);
 	
 	// printf("\n");
 	ComputerSystem_DebugMessage(100, ERROR, "\n");
+	FlightRecorder_Dump("Assert failed");
 }
 
 
 void Asserts_CheckAsserts(){
 	int na;
-	int globalCounter=Clock_GetTime();
+	SIMTIME globalCounter=Clock_GetTime();
 	
- 	// Checking unique time asserts
-	while (Asserts_IsThereANewAssert(globalCounter)>0) {
-		na=Heap_poll(assertsQueue,QUEUE_ASSERTS,&numOfElementsInAssertsQueue);
-		if (asserts[na].time==globalCounter) {
-            Asserts_CheckOneAssert(na);
-		}
-		else {
-			ComputerSystem_DebugMessage(93,ERROR,asserts[na].time,asserts[na].element); 
+ 	// Checking unique time asserts, only when the clock has reached the first of them
+	if (assertsCheckpoint) {
+		assertsCheckpoint=0;
+		if (assertsBinary)
+			Asserts_CheckFileAsserts(globalCounter);
+		else while (Asserts_IsThereANewAssert(globalCounter)>0) {
+			na=Heap_poll(assertsQueue,QUEUE_ASSERTS,&numOfElementsInAssertsQueue);
+			if (asserts[na].time==globalCounter) {
+	            Asserts_CheckOneAssert(&asserts[na]);
+			}
+			else {
+				ComputerSystem_DebugMessage(93,ERROR,asserts[na].time,elements[asserts[na].element]);
+			}
 		}
+		Asserts_ScheduleCheckpoint();
+	}
+
+	// Checking asserts for all time on the memory cells written since the last check
+	while (numberOfWrittenCells>0) {
+		int address=writtenCells[--numberOfWrittenCells];
+		assertsCellState[address]=CELL_WATCHED;
+		for (na=assertsOfCell[address]; na>=0; na=asserts[na].nextInCell)
+			Asserts_CheckAllTimeAssert(na);
 	}
 
 	na=beginOfAllTimeAsserts;
 
-   // Checking asserts for all time
- 	while (na<MAX_ASSERTS) {
- 		 Asserts_CheckOneAssert(assertsQueue[na++].info);
+   // Checking the rest of asserts for all time
+ 	while (na<endOfAllTimeAsserts) {
+ 		 Asserts_CheckAllTimeAssert(assertsQueue[na++].info);
  	}
 }
 
-void Asserts_CheckOneAssert(int na){
+// With all time asserts (or when generating asserts) every instruction is checked
+int Asserts_CheckedEveryInstruction() {
+	return GEN_ASSERTS || beginOfAllTimeAsserts<endOfAllTimeAsserts || numberOfCellAsserts>0;
+}
+
+void Asserts_CheckOneAssert(ASSERT_DATA *a){
+	int realValue=Asserts_ReadElement(a->element, a->address);
+
+	if ((realValue!=a->value) || GEN_ASSERTS)
+		assertMsg(Clock_GetTime(),a->element,a->value,realValue,a->address);
+}
+
+// Checks the asserts of the binary file up to the current time
+void Asserts_CheckFileAsserts(SIMTIME currentTime) {
+	ASSERTSFILE_RECORD *record;
+	ASSERT_DATA a;
+
+	while ((record=AssertsFile_Peek(&assertsCursor))!=NULL && record->time<=currentTime) {
+		if (Asserts_ValidRecord(record)) {
+			if (record->time==currentTime) {
+				a.time=record->time;
+				a.value=record->value;
+				a.element=record->element;
+				a.address=record->address;
+				Asserts_CheckOneAssert(&a);
+			}
+			else
+				ComputerSystem_DebugMessage(93,ERROR,record->time,elements[record->element]);
+		}
+		AssertsFile_Next(&assertsCursor);
+	}
+}
+
+// An all time assert is evaluated again only when the value it watches has changed
+void Asserts_CheckAllTimeAssert(int na){
+	int realValue=Asserts_ReadElement(asserts[na].element, asserts[na].address);
+
+	if (asserts[na].checked && realValue==asserts[na].lastValue && !GEN_ASSERTS)
+		return;
+	asserts[na].checked=1;
+	asserts[na].lastValue=realValue;
+	if ((realValue!=asserts[na].value) || GEN_ASSERTS)
+		assertMsg(Clock_GetTime(),asserts[na].element,asserts[na].value,realValue,asserts[na].address);
+}
+
+// Real value of an element of the computer system
+int Asserts_ReadElement(int element, int address){
 	MEMORYCELL data;
 	BUSDATACELL busData;
-	int op=elementNumber(asserts[na].element);
-	int globalCounter=Clock_GetTime();
-
-	// Decode
-	int operationCode;
-	int operand1;
-	int operand2;
-	int memCell;
-	int valueInPCB;
 
-	switch (op) {
+	switch (element) {
 		case RMEM_OP: 
-				busData.cell=mainMemory[MMU_GetBase()+asserts[na].address];
-				operationCode=Processor_DecodeOperationCode(busData);
-				if ((operationCode!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[RMEM_OP],asserts[na].value,operationCode,asserts[na].address);
-				break;
 		case RMEM_O1:  	
-				busData.cell=mainMemory[MMU_GetBase()+asserts[na].address];
-				operand1=Processor_DecodeOperand1(busData);
-				if ((operand1!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[RMEM_O1],asserts[na].value,operand1,asserts[na].address);
-				break;		
 		case RMEM_O2:
-				busData.cell=mainMemory[MMU_GetBase()+asserts[na].address];
-				operand2=Processor_DecodeOperand2(busData);
-				if ((operand2!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[RMEM_O2],asserts[na].value,operand2,asserts[na].address);
-			  	break;
+		case RMEM:
+				busData.cell=mainMemory[MMU_GetBase()+address];
+				break;
 		case AMEM_OP: 				       
-				busData.cell=mainMemory[MMU_GetBase()+asserts[na].address];
-				operationCode=Processor_DecodeOperationCode(busData);
-				if ((operationCode!=asserts[na].value) || GEN_ASSERTS)																																			
-					assertMsg(globalCounter,elements[AMEM_OP],asserts[na].value,operationCode,asserts[na].address);
 		case AMEM_O1:  
-				busData.cell=mainMemory[asserts[na].address];
-				operand1=Processor_DecodeOperand1(busData);
-				if ((operand1!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[AMEM_O1],asserts[na].value,operand1,asserts[na].address);
-			 	break;
 		case AMEM_O2:
-				busData.cell=mainMemory[asserts[na].address];
-				operand2=Processor_DecodeOperand2(busData);
-				if ((operand2!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[AMEM_O2],asserts[na].value,operand2,asserts[na].address);
-			 	break;	 		 	
-		case PC:  
-				if ((registerPC_CPU!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[PC],asserts[na].value,registerPC_CPU,0);
-				break;
-		case ACC:  
-				if ((registerAccumulator_CPU!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[ACC],asserts[na].value,registerAccumulator_CPU,0);
+		case AMEM: 				       
+				busData.cell=mainMemory[address];
 				break;
 		case IR_OP: 
-				operationCode=Processor_DecodeOperationCode(registerIR_CPU);
-				if ((operationCode!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[IR_OP],asserts[na].value,operationCode,0);
-				break;
 		case IR_O1:
-				operand1=Processor_DecodeOperand1(registerIR_CPU);
-				if ((operand1!= asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[IR_O1],asserts[na].value,operand1,0);
-				break;
 		case IR_O2:
-				operand2=Processor_DecodeOperand2(registerIR_CPU);
-				if ((operand2!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[IR_O2],asserts[na].value,operand2,0);			
-				break;
-		case PSW:
-				if ((registerPSW_CPU!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[PSW],asserts[na].value,registerPSW_CPU,0);
-				break;
-		case MAR: 
-				if ((registerMAR_CPU!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MAR],asserts[na].value,registerMAR_CPU,0);
+				busData=registerIR_CPU;
 				break;
 		case MBR_OP:
-				operationCode=Processor_DecodeOperationCode(registerMBR_CPU);
-				if ((operationCode!=asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MBR_OP],asserts[na].value,operationCode,0);
-				break;
 		case MBR_O1:
-				operand1=Processor_DecodeOperand1(registerMBR_CPU);
-				if ((operand1!= asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MBR_O1],asserts[na].value,operand1,0);
-				break;
 		case MBR_O2:
-				operand2=Processor_DecodeOperand2(registerMBR_CPU);
-				if ((operand2!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MBR_O2],asserts[na].value,operand2,0);	
-				break;
-		case MMU_BS:
-				if ((MMU_GetBase()!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MMU_BS],asserts[na].value,MMU_GetBase(),0);
-				break;
-		case MMU_LM:
-				if ((MMU_GetLimit()!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MMU_LM],asserts[na].value,MMU_GetLimit(),0);
-				break;
-		case MMU_MAR:
-				if ((MMU_GetMAR()!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MMU_MAR],asserts[na].value,MMU_GetMAR(),0);
-				break;
-		case MMEM_MAR:
-				if ((MainMemory_GetMAR()!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MMEM_MAR],asserts[na].value,MainMemory_GetMAR(),0);
+		case MBR:
+				busData=registerMBR_CPU;
 				break;
 		case MMBR_OP:
-				MainMemory_GetMBR(&data);
-				busData.cell=data;
-				operationCode=Processor_DecodeOperationCode(busData);
-				if ((operationCode!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MMBR_OP],asserts[na].value,operationCode,0);
-				break;
 		case MMBR_O1:
-				MainMemory_GetMBR(&data);
-				busData.cell=data;
-				operand1=Processor_DecodeOperand1(busData);
-				if ((operand1!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MMBR_O1],asserts[na].value,operand1,0);
-				break;
 		case MMBR_O2:
-				MainMemory_GetMBR(&data);
-				busData.cell=data;
-				operand2=Processor_DecodeOperand2(busData);
-				if ((operand2!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MMBR_O2],asserts[na].value,operand2,0);
-				break;
-		case XPID:
-				if ((executingProcessID!=asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[XPID],asserts[na].value,executingProcessID,0);
-				break;
-		case RMEM:
-				memCell=mainMemory[MMU_GetBase()+asserts[na].address];
-				if (memCell !=asserts[na].value || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[RMEM],asserts[na].value,memCell,asserts[na].address);
-			  	break;
-		case AMEM: 				       
-				memCell=mainMemory[asserts[na].address];
-				if (memCell!=asserts[na].value || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[AMEM],asserts[na].value,memCell,asserts[na].address);
-			 	break;
-		case MBR:
-			if ((registerMBR_CPU.cell != asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MBR],asserts[na].value,registerMBR_CPU.cell,0);
-				break;
 		case MMBR:
 				MainMemory_GetMBR(&data);
 				busData.cell=data;
-				if ((busData.cell != asserts[na].value)|| GEN_ASSERTS)
-					assertMsg(globalCounter,elements[MMBR],asserts[na].value,busData.cell,0);
 				break;
+		case PC:  
+				return registerPC_CPU;
+		case ACC:  
+				return registerAccumulator_CPU;
+		case PSW:
+				return registerPSW_CPU;
+		case MAR: 
+				return registerMAR_CPU;
+		case MMU_BS:
+				return MMU_GetBase();
+		case MMU_LM:
+				return MMU_GetLimit();
+		case MMU_MAR:
+				return MMU_GetMAR();
+		case MMEM_MAR:
+				return MainMemory_GetMAR();
+		case XPID:
+				return executingProcessID;
 		case PCB_ST:
-				valueInPCB=processTable[asserts[na].address].state;
-				if ((valueInPCB != asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[PCB_ST],asserts[na].value,valueInPCB,0);			
-				break;
+				return processTable[address].state;
 		case PCB_PC:
-				valueInPCB=processTable[asserts[na].address].copyOfPCRegister;
-				if ((valueInPCB != asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[PCB_PC],asserts[na].value,valueInPCB,0);			
-				break;
+				return processTable[address].copyOfPCRegister;
 		case PCB_PR:
-				valueInPCB=processTable[asserts[na].address].priority;
-				if ((valueInPCB != asserts[na].value) || GEN_ASSERTS)
-					assertMsg(globalCounter,elements[PCB_PR],asserts[na].value,valueInPCB,0);			
-				break;
-		default: ;
+				return processTable[address].priority;
+		default:
+				return 0;
+	}
 
+	switch (element) {
+		case RMEM_OP: case AMEM_OP: case IR_OP: case MBR_OP: case MMBR_OP:
+				return Processor_DecodeOperationCode(busData);
+		case RMEM_O1: case AMEM_O1: case IR_O1: case MBR_O1: case MMBR_O1:
+				return Processor_DecodeOperand1(busData);
+		case RMEM_O2: case AMEM_O2: case IR_O2: case MBR_O2: case MMBR_O2:
+				return Processor_DecodeOperand2(busData);
+		default:
+				return busData.cell;
+	}
+}
+
+// Main memory tells every write; the cell is queued only if an assert watches it
+void Asserts_MemoryWritten(int address) {
+	if (assertsCellState[address]==CELL_WATCHED) {
+		assertsCellState[address]=CELL_WRITTEN;
+		writtenCells[numberOfWrittenCells++]=address;
 	}
 }
 
@@ -481,7 +409,7 @@ void Asserts_CheckOneAssert(int na){
 //		1 if any asserts is now
 //		0 else
 // considered by CheckAsserts to compare at the current time
-int Asserts_IsThereANewAssert(int currentTime) {
+int Asserts_IsThereANewAssert(SIMTIME currentTime) {
 #ifdef QUEUE_ASSERTS
 		int indexInAsserts = Heap_getFirst(assertsQueue,numOfElementsInAssertsQueue);
 
@@ -494,8 +422,44 @@ int Asserts_IsThereANewAssert(int currentTime) {
 		return 0;  //  No assert in current time
 }
 
+// The clock will tell when the first assert in assertsQueue has to be checked
+void Asserts_ScheduleCheckpoint() {
+	ASSERTSFILE_RECORD *record;
+	int indexInAsserts;
+
+	if (assertsBinary) {
+		if ((record=AssertsFile_Peek(&assertsCursor))!=NULL)
+			Events_Schedule(record->time, EVENT_ASSERT, 0);
+		return;
+	}
+	indexInAsserts = Heap_getFirst(assertsQueue,numOfElementsInAssertsQueue);
+
+	if (indexInAsserts >= 0)
+		Events_Schedule(asserts[indexInAsserts].time, EVENT_ASSERT, 0);
+}
+
+// Asserts up to a time are left unchecked (a simulation restored from a checkpoint)
+void Asserts_SkipAsserts(SIMTIME time) {
+	ASSERTSFILE_RECORD *record;
+
+	if (assertsBinary)
+		while ((record=AssertsFile_Peek(&assertsCursor))!=NULL && record->time<=time)
+			AssertsFile_Next(&assertsCursor);
+	else while (Asserts_IsThereANewAssert(time)>0)
+		Heap_poll(assertsQueue,QUEUE_ASSERTS,&numOfElementsInAssertsQueue);
+}
+
+void Asserts_CheckpointEvent() {
+	assertsCheckpoint=1;
+}
+
 void Asserts_TerminateAssertions(){
-	if (numOfElementsInAssertsQueue)
+	if (assertsBinary) {
+		if (AssertsFile_Remaining(&assertsCursor))
+			ComputerSystem_DebugMessage(92,ERROR,(int) AssertsFile_Remaining(&assertsCursor));
+		AssertsFile_Close(&assertsCursor);
+	}
+	else if (numOfElementsInAssertsQueue)
 		// printf("Warning, numOfElementsInAssertsQueue unchecked asserts in Asserts queue !!! );
 		ComputerSystem_DebugMessage(92,ERROR,numOfElementsInAssertsQueue);
 };
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "AssertsFile.h"
+#include "Processor.h"
+
+char *elements[]={
+#define ASSERT_ELEMENT(name,valueIsInstruction,shownAsInstruction,address,watch,golden) #name,
+#include "AssertElements.def"
+#undef ASSERT_ELEMENT
+	NULL};
+
+// Properties of the elements, indexed by element
+int elementValueIsInstruction[]={
+#define ASSERT_ELEMENT(name,valueIsInstruction,shownAsInstruction,address,watch,golden) valueIsInstruction,
+#include "AssertElements.def"
+#undef ASSERT_ELEMENT
+	};
+int elementShownAsInstruction[]={
+#define ASSERT_ELEMENT(name,valueIsInstruction,shownAsInstruction,address,watch,golden) shownAsInstruction,
+#include "AssertElements.def"
+#undef ASSERT_ELEMENT
+	};
+int elementAddress[]={
+#define ASSERT_ELEMENT(name,valueIsInstruction,shownAsInstruction,address,watch,golden) address,
+#include "AssertElements.def"
+#undef ASSERT_ELEMENT
+	};
+int elementWatch[]={
+#define ASSERT_ELEMENT(name,valueIsInstruction,shownAsInstruction,address,watch,golden) watch,
+#include "AssertElements.def"
+#undef ASSERT_ELEMENT
+	};
+int elementGolden[]={
+#define ASSERT_ELEMENT(name,valueIsInstruction,shownAsInstruction,address,watch,golden) golden,
+#include "AssertElements.def"
+#undef ASSERT_ELEMENT
+	};
+
+// Search assert element linearly into the array
+int AssertsFile_ElementNumber(char *cmp) {
+ int n=0;
+
+ while ((elements[n]!=NULL) && strcmp(cmp, elements[n]))
+   n++;
+
+ if (elements[n]==NULL) return -1;
+ else return n;
+	
+}
+
+void strcpySpaces(char *target, char *src, int nChars) {
+	int l, s, t;
+
+	l=strlen(src);
+	t=0;
+	for (s=0; (t<nChars-1) && (s<l); s++) {
+		if (src[s]!=' ' && src[s]!='\n' && src[s]!='\r')
+			target[t++]=src[s];
+	}
+	target[t]=0;
+}
+
+// Absolute addresses and PIDs are checked when the assert is loaded
+int AssertsFile_ValidAddress(int element, int address) {
+	if (elementAddress[element]==ASSERT_PCBADDRESS)
+		return address>=0 && address<PROCESSTABLEMAXSIZE;
+	if (elementWatch[element]==ASSERT_WATCHCELL)
+		return address>=0 && address<MAINMEMORYSIZE;
+	return 1;
+}
+
+// Parses a line of a text asserts file: time,element,value[,address]
+// Returns 0, ASSERTSFILE_SKIP for comments and empty lines or the number of the
+// message telling the error (value is set for message 86)
+int AssertsFile_ParseLine(char *lineRead, ASSERT_DATA *a, char **valueRead) {
+	char *time, *element, *value, *address;
+	char svalue[E_SIZE];
+	char elementName[E_SIZE];
+	int rc;
+
+	// reading up to 4 items for assert
+	time=strtok(lineRead,",");
+	if (time==NULL)
+		return 84;
+
+	if ((time[0]=='/') || (time[0]=='\n')|| (time[0]=='\r'))
+		return ASSERTSFILE_SKIP; // Skip coments and empty lines
+
+	element=strtok(NULL,",");
+	if (element==NULL)
+		return 84;
+
+	value=strtok(NULL,",");
+	if (value==NULL)
+		return 84;
+	address=strtok(NULL,"\n");
+
+	strcpySpaces(elementName, element,E_SIZE);
+	a->element=AssertsFile_ElementNumber(elementName);
+	if (a->element<0)
+		return 84;
+	if (strcmp(time,"*")) {
+		rc=sscanf(time,"%lld",&a->time);
+		if (rc==0)
+			return 85;
+	}
+	else a->time=-33; // All the instants of time.
+
+	// If an Operation code read string (RMEM_OP, AMEM_OP,IR_OP, MBR_OP, MMBR_OP)
+	if (elementValueIsInstruction[a->element]) {
+		strcpySpaces(svalue, value,E_SIZE);
+		a->value=Processor_ToInstruction(svalue);
+		if (a->value<0)
+			rc=0;
+	}
+	else
+		rc=sscanf(value,"%d",&a->value);
+
+	if (rc==0) {
+		*valueRead=value;
+		return 86;
+	}
+
+	// If memory cell or PCB we read address
+	if (elementAddress[a->element]!=ASSERT_NOADDRESS) {
+		if (address==NULL)
+			return 84;
+		rc=sscanf(address,"%d",&a->address);
+		if (rc==0 || !AssertsFile_ValidAddress(a->element, a->address))
+			return 87;
+	}
+	else a->address=0;
+
+	a->checked=0;
+	a->nextInCell=-1;
+	return 0;
+}
+
+// Maps a binary asserts file. Returns -1 if it cannot be opened or is not a binary asserts file
+int AssertsFile_Open(char *name, ASSERTSFILE_CURSOR *cursor, ASSERTSFILE_HEADER *header) {
+	struct stat fileStatus;
+	int fd;
+
+	fd=open(name, O_RDONLY);
+	if (fd<0)
+		return -1;
+	if (fstat(fd, &fileStatus)<0 || fileStatus.st_size<(off_t) sizeof(ASSERTSFILE_HEADER)
+	 || read(fd, header, sizeof(ASSERTSFILE_HEADER))!=sizeof(ASSERTSFILE_HEADER)
+	 || memcmp(header->magic, ASSERTSFILE_MAGIC, ASSERTSFILE_MAGICLENGTH)
+	 || header->recordSize!=sizeof(ASSERTSFILE_RECORD)
+	 || header->numberOfAsserts<0
+	 || fileStatus.st_size!=(off_t) (sizeof(ASSERTSFILE_HEADER)+header->numberOfAsserts*sizeof(ASSERTSFILE_RECORD))) {
+		close(fd);
+		return -1;
+	}
+	cursor->mapSize=fileStatus.st_size;
+	cursor->map=mmap(NULL, cursor->mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (cursor->map==MAP_FAILED)
+		return -1;
+	madvise(cursor->map, cursor->mapSize, MADV_SEQUENTIAL);
+	cursor->records=(ASSERTSFILE_RECORD *) (cursor->map+sizeof(ASSERTSFILE_HEADER));
+	cursor->numberOfAsserts=header->numberOfAsserts;
+	cursor->next=0;
+	cursor->released=0;
+	return 0;
+}
+
+// Next assert of the cursor, NULL at the end
+ASSERTSFILE_RECORD *AssertsFile_Peek(ASSERTSFILE_CURSOR *cursor) {
+	if (cursor->next>=cursor->numberOfAsserts)
+		return NULL;
+	return &cursor->records[cursor->next];
+}
+
+void AssertsFile_Next(ASSERTSFILE_CURSOR *cursor) {
+	size_t consumed;
+
+	cursor->next++;
+	consumed=(char *) &cursor->records[cursor->next]-cursor->map;
+	if (consumed-cursor->released>=ASSERTSFILE_WINDOW) {
+		// Whole pages behind the cursor are not needed any more
+		consumed-=consumed%sysconf(_SC_PAGESIZE);
+		madvise(cursor->map+cursor->released, consumed-cursor->released, MADV_DONTNEED);
+		cursor->released=consumed;
+	}
+}
+
+long long AssertsFile_Remaining(ASSERTSFILE_CURSOR *cursor) {
+	return cursor->numberOfAsserts-cursor->next;
+}
+
+void AssertsFile_Close(ASSERTSFILE_CURSOR *cursor) {
+	if (cursor->map!=NULL)
+		munmap(cursor->map, cursor->mapSize);
+	cursor->map=NULL;
+}
@@ -0,0 +1,60 @@
+#ifndef ASSERTSFILE_H
+#define ASSERTSFILE_H
+
+#include "Simulator.h"
+#include "Asserts.h"
+
+// Binary asserts file, made by the simasserts tool from a text asserts file:
+// a header and then the asserts sorted by time. All time asserts (time -33) are first
+#define ASSERTSFILE_MAGIC "SIMASRT\001"
+#define ASSERTSFILE_MAGICLENGTH 8
+
+typedef struct {
+	char magic[ASSERTSFILE_MAGICLENGTH];
+	int recordSize;
+	int numberOfAllTimeAsserts;
+	long long numberOfAsserts;
+} ASSERTSFILE_HEADER;
+
+typedef struct {
+	SIMTIME time;
+	int element;
+	int value;
+	int address;
+	int lineNumber;	// In the text asserts file
+} ASSERTSFILE_RECORD;
+
+// The binary file is mapped and read through a cursor. Pages already consumed are
+// released every ASSERTSFILE_WINDOW bytes, so only the upcoming asserts stay resident
+#define ASSERTSFILE_WINDOW (1024*1024)
+
+typedef struct {
+	char *map;
+	size_t mapSize;
+	ASSERTSFILE_RECORD *records;
+	long long numberOfAsserts;
+	long long next;
+	size_t released;
+} ASSERTSFILE_CURSOR;
+
+// Text line parsing results
+#define ASSERTSFILE_SKIP -1
+
+extern char *elements[];
+extern int elementValueIsInstruction[];
+extern int elementShownAsInstruction[];
+extern int elementAddress[];
+extern int elementWatch[];
+extern int elementGolden[];
+
+// Functions prototypes
+int AssertsFile_ElementNumber(char *);
+int AssertsFile_ValidAddress(int, int);
+int AssertsFile_ParseLine(char *, ASSERT_DATA *, char **);
+int AssertsFile_Open(char *, ASSERTSFILE_CURSOR *, ASSERTSFILE_HEADER *);
+ASSERTSFILE_RECORD *AssertsFile_Peek(ASSERTSFILE_CURSOR *);
+void AssertsFile_Next(ASSERTSFILE_CURSOR *);
+long long AssertsFile_Remaining(ASSERTSFILE_CURSOR *);
+void AssertsFile_Close(ASSERTSFILE_CURSOR *);
+
+#endif
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <string.h>
+#include "BinaryLog.h"
+#include "Varint.h"
+#include "Log.h"
+
+// State of every output stream (one per section with the sections sink)
+int binaryLogHeaderWritten[LOGMAXSTREAMS];
+SIMTIME binaryLogLastTick[LOGMAXSTREAMS];
+unsigned int binaryLogDefinedIn[NUMBEROFMSGS]; // Bit per stream where the message is defined
+
+// Record under construction, written into the log when full or complete
+char binaryLogBuffer[LOGMAXRECORD];
+int binaryLogLength;
+char binaryLogSection;
+
+// Internal Functions prototypes
+void BinaryLog_Begin(char);
+void BinaryLog_Put(const void *, int);
+void BinaryLog_PutUnsigned(unsigned long long);
+void BinaryLog_PutSigned(long long);
+void BinaryLog_End();
+int BinaryLog_GetUnsigned(BINARYLOG_READER *, unsigned long long *);
+int BinaryLog_GetSigned(BINARYLOG_READER *, long long *);
+int BinaryLog_GetString(BINARYLOG_READER *, char *, int, int *);
+
+// A debug message with its raw argument values. Its definition goes first, once per stream
+void BinaryLog_Message(int msgNo, int pos, MESSAGE_ARG args[], char section, int coloured, SIMTIME tick, int PID) {
+	DEBUG_MESSAGES *message=&DebugMessages[pos];
+	int stream=Log_Stream(section);
+	int i, length;
+	unsigned char byte;
+
+	BinaryLog_Begin(section);
+	if (!(binaryLogDefinedIn[pos] & (1u << stream))) {
+		binaryLogDefinedIn[pos]|=1u << stream;
+		length=strlen(message->format);
+		BinaryLog_Put("D", 1);
+		BinaryLog_PutUnsigned(msgNo);
+		BinaryLog_PutUnsigned(length);
+		BinaryLog_Put(message->format, length);
+	}
+	byte=section | (coloured ? BINARYLOG_COLOURED : 0);
+	BinaryLog_Put("M", 1);
+	BinaryLog_PutUnsigned(msgNo);
+	BinaryLog_Put(&byte, 1);
+	BinaryLog_PutUnsigned(tick-binaryLogLastTick[stream]);
+	binaryLogLastTick[stream]=tick;
+	BinaryLog_PutSigned(PID);
+	for (i=0; i<message->numberOfArguments; i++)
+		switch (message->argumentTypes[i]) {
+			case ARGUMENT_STRING:
+				length=args[i].s==NULL ? 0 : strlen(args[i].s);
+				BinaryLog_PutUnsigned(length);
+				BinaryLog_Put(args[i].s, length);
+				break;
+			case ARGUMENT_SIMTIME:
+				BinaryLog_PutSigned(args[i].l);
+				break;
+			case ARGUMENT_DOUBLE:
+				BinaryLog_Put(&args[i].f, sizeof(double));
+				break;
+			case ARGUMENT_CHAR:
+				byte=(unsigned char) args[i].d;
+				BinaryLog_Put(&byte, 1);
+				break;
+			default:
+				BinaryLog_PutSigned(args[i].d);
+		}
+	BinaryLog_End();
+}
+
+// A new sink has neither the headers nor the message definitions
+void BinaryLog_Reset() {
+	memset(binaryLogHeaderWritten, 0, sizeof(binaryLogHeaderWritten));
+	memset(binaryLogLastTick, 0, sizeof(binaryLogLastTick));
+	memset(binaryLogDefinedIn, 0, sizeof(binaryLogDefinedIn));
+	binaryLogLength=0;
+}
+
+// Text not coming from a debug message
+void BinaryLog_Text(char section, const char *text, int length) {
+	BinaryLog_Begin(section);
+	BinaryLog_Put("T", 1);
+	BinaryLog_Put(&section, 1);
+	BinaryLog_PutUnsigned(length);
+	BinaryLog_Put(text, length);
+	BinaryLog_End();
+}
+
+void BinaryLog_Begin(char section) {
+	int stream=Log_Stream(section);
+
+	binaryLogSection=section;
+	binaryLogLength=0;
+	if (!binaryLogHeaderWritten[stream]) {
+		binaryLogHeaderWritten[stream]=1;
+		BinaryLog_Put(BINARYLOG_MAGIC, BINARYLOG_MAGICLENGTH);
+	}
+}
+
+void BinaryLog_Put(const void *data, int length) {
+	int chunk;
+
+	while (length>0) {
+		if (binaryLogLength==LOGMAXRECORD) {
+			Log_Write(binaryLogSection, binaryLogBuffer, binaryLogLength);
+			binaryLogLength=0;
+		}
+		chunk=LOGMAXRECORD-binaryLogLength;
+		if (chunk>length)
+			chunk=length;
+		memcpy(&binaryLogBuffer[binaryLogLength], data, chunk);
+		binaryLogLength+=chunk;
+		data=(const char *) data+chunk;
+		length-=chunk;
+	}
+}
+
+void BinaryLog_PutUnsigned(unsigned long long value) {
+	unsigned char bytes[VARINT_MAXLENGTH];
+
+	BinaryLog_Put(bytes, Varint_Encode(value, bytes));
+}
+
+void BinaryLog_PutSigned(long long value) {
+	BinaryLog_PutUnsigned(Varint_ZigZag(value));
+}
+
+void BinaryLog_End() {
+	Log_Write(binaryLogSection, binaryLogBuffer, binaryLogLength);
+}
+
+// Checks the header of a binary log
+int BinaryLog_OpenReader(BINARYLOG_READER *reader, FILE *stream) {
+	char magic[BINARYLOG_MAGICLENGTH];
+
+	reader->stream=stream;
+	reader->tick=0;
+	if (fread(magic, 1, BINARYLOG_MAGICLENGTH, stream)!=BINARYLOG_MAGICLENGTH
+		|| memcmp(magic, BINARYLOG_MAGIC, BINARYLOG_MAGICLENGTH))
+		return -1;
+	return 0;
+}
+
+int BinaryLog_Read(BINARYLOG_READER *reader, BINARYLOG_RECORD *record) {
+	int type, section, byte, i, pos, length;
+	unsigned long long value;
+	long long signedValue;
+	DEBUG_MESSAGES *message;
+
+	if ((type=fgetc(reader->stream))==EOF)
+		return 0;
+	record->type=type;
+	switch (type) {
+		case BINARYLOG_DEFINITION:
+			if (BinaryLog_GetUnsigned(reader, &value)<0
+				|| BinaryLog_GetString(reader, record->text, MSGMAXIMUMLENGTH, &record->textLength)<0)
+				return -1;
+			record->messageNumber=value;
+			// Known from now on: later records are decoded with its argument types
+			Messages_Set(record->messageNumber, record->text);
+			return type;
+		case BINARYLOG_MESSAGE:
+			if (BinaryLog_GetUnsigned(reader, &value)<0 || (section=fgetc(reader->stream))==EOF)
+				return -1;
+			record->messageNumber=value;
+			record->section=section & ~BINARYLOG_COLOURED;
+			record->coloured=(section & BINARYLOG_COLOURED)!=0;
+			if (BinaryLog_GetUnsigned(reader, &value)<0 || BinaryLog_GetSigned(reader, &signedValue)<0)
+				return -1;
+			reader->tick+=value;
+			record->tick=reader->tick;
+			record->PID=signedValue;
+			if ((pos=Messages_Get_Pos(record->messageNumber))<0)
+				return -1;
+			message=&DebugMessages[pos];
+			for (i=0; i<message->numberOfArguments; i++)
+				switch (message->argumentTypes[i]) {
+					case ARGUMENT_STRING:
+						if (BinaryLog_GetString(reader, record->strings[i], BINARYLOG_MAXSTRING, &length)<0)
+							return -1;
+						record->args[i].s=record->strings[i];
+						break;
+					case ARGUMENT_SIMTIME:
+						if (BinaryLog_GetSigned(reader, &signedValue)<0)
+							return -1;
+						record->args[i].l=signedValue;
+						break;
+					case ARGUMENT_DOUBLE:
+						if (fread(&record->args[i].f, sizeof(double), 1, reader->stream)!=1)
+							return -1;
+						break;
+					case ARGUMENT_CHAR:
+						if ((byte=fgetc(reader->stream))==EOF)
+							return -1;
+						record->args[i].d=(char) byte;
+						break;
+					default:
+						if (BinaryLog_GetSigned(reader, &signedValue)<0)
+							return -1;
+						record->args[i].d=signedValue;
+				}
+			return type;
+		case BINARYLOG_TEXT:
+			if ((section=fgetc(reader->stream))==EOF
+				|| BinaryLog_GetString(reader, record->text, sizeof(record->text), &record->textLength)<0)
+				return -1;
+			record->section=section;
+			return type;
+	}
+	return -1;
+}
+
+int BinaryLog_GetUnsigned(BINARYLOG_READER *reader, unsigned long long *value) {
+	return Varint_Read(reader->stream, value);
+}
+
+int BinaryLog_GetSigned(BINARYLOG_READER *reader, long long *value) {
+	unsigned long long encoded;
+
+	if (BinaryLog_GetUnsigned(reader, &encoded)<0)
+		return -1;
+	*value=Varint_UnZigZag(encoded);
+	return 0;
+}
+
+// Reads a string into a buffer of the given size, skipping what does not fit
+int BinaryLog_GetString(BINARYLOG_READER *reader, char *text, int size, int *length) {
+	unsigned long long stringLength;
+	int kept;
+
+	if (BinaryLog_GetUnsigned(reader, &stringLength)<0)
+		return -1;
+	kept=stringLength<(unsigned long long) size ? stringLength : size-1;
+	if (fread(text, 1, kept, reader->stream)!=(size_t) kept)
+		return -1;
+	text[kept]=0;
+	*length=kept;
+	if (stringLength>kept && fseek(reader->stream, stringLength-kept, SEEK_CUR)!=0)
+		return -1;
+	return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef BINARYLOG_H
+#define BINARYLOG_H
+
+#include <stdio.h>
+#include "Simulator.h"
+#include "Messages.h"
+#include "Log.h"
+
+// Binary log: every stream starts with BINARYLOG_MAGIC followed by records. Integers
+// are varints (signed ones zigzag encoded), strings are a length and their bytes:
+//   'D' message number, format				Definition, before the first use of a message
+//   'M' message number, section, tick increment, PID, arguments	A debug message
+//   'T' section, text							Text already rendered
+// Sections have bit 7 set when the message is coloured
+#define BINARYLOG_MAGIC "SIMLOG\001"
+#define BINARYLOG_MAGICLENGTH 7
+
+#define BINARYLOG_DEFINITION 'D'
+#define BINARYLOG_MESSAGE 'M'
+#define BINARYLOG_TEXT 'T'
+#define BINARYLOG_COLOURED 0x80
+
+#define BINARYLOG_MAXSTRING 1024
+
+// Functions prototypes
+void BinaryLog_Message(int, int, MESSAGE_ARG[], char, int, SIMTIME, int);
+void BinaryLog_Text(char, const char *, int);
+void BinaryLog_Reset();
+
+// Decoding, for the simlog tool. The reader returns the record type, 0 at the end and -1 if wrong
+typedef struct {
+	FILE *stream;
+	SIMTIME tick;
+} BINARYLOG_READER;
+
+typedef struct {
+	int type;
+	int messageNumber;
+	char section;
+	int coloured;
+	int PID;
+	SIMTIME tick;
+	char text[LOGMAXRECORD+1];		// Format of 'D', text of 'T' (as long as any record of the log)
+	int textLength;
+	MESSAGE_ARG args[MSGMAXIMUMLENGTH];
+	char strings[MSGMAXIMUMLENGTH][BINARYLOG_MAXSTRING];	// Storage for the string arguments (truncated if too long)
+} BINARYLOG_RECORD;
+
+int BinaryLog_OpenReader(BINARYLOG_READER *, FILE *);
+int BinaryLog_Read(BINARYLOG_READER *, BINARYLOG_RECORD *);
+
+#endif
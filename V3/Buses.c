@@ -120,3 +120,42 @@ int Buses_write_ControlBus_From_To(int fromRegister, int toRegister){
 	return Bus_SUCCESS;
 
 }
+
+extern int registerMAR_CPU;
+extern BUSDATACELL registerMBR_CPU;
+extern int registerCTRL_CPU;
+extern int registerBase_MMU;
+extern int registerLimit_MMU;
+extern int registerMAR_MMU;
+extern int registerCTRL_MMU;
+extern MEMORYCELL mainMemory[];
+extern int registerMAR_MainMemory;
+extern MEMORYCELL registerMBR_MainMemory;
+extern int registerCTRL_MainMemory;
+
+// Fast path of a read of the CPU at the address in its MAR: no bus transfers, but the
+// registers of the CPU, the MMU and the main memory end as with them (MMU_SetCTRL and
+// MainMemory_SetCTRL), failures included
+void Buses_FastRead_CPU() {
+	int inRange;
+
+	registerMAR_MMU=registerMAR_CPU;
+	registerCTRL_MMU=CTRLREAD;
+	if (Processor_PSW_BitState(EXECUTION_MODE_BIT)) // Protected mode
+		inRange=registerMAR_MMU < MAINMEMORYSIZE;
+	else {
+		inRange=registerMAR_MMU < registerLimit_MMU;
+		if (inRange)
+			registerMAR_MMU+=registerBase_MMU;
+	}
+	if (inRange) {
+		registerMAR_MainMemory=registerMAR_MMU;
+		registerMBR_MainMemory=mainMemory[registerMAR_MainMemory];
+		registerCTRL_MainMemory=CTRLREAD | CTRL_SUCCESS;
+		registerMBR_CPU.cell=registerMBR_MainMemory;
+		registerCTRL_MMU|=CTRL_SUCCESS;
+	}
+	else
+		registerCTRL_MMU|=CTRL_FAIL;
+	registerCTRL_CPU=registerCTRL_MMU & 0xff;
+}
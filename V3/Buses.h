@@ -19,5 +19,6 @@ typedef struct {
 int Buses_write_AddressBus_From_To(int, int);
 int Buses_write_DataBus_From_To(int, int);
 int Buses_write_ControlBus_From_To(int, int);
+void Buses_FastRead_CPU();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,530 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "Checkpoint.h"
+#include "MainMemory.h"
+#include "Processor.h"
+#include "ProcessorBase.h"
+#include "ComputerSystem.h"
+#include "OperatingSystem.h"
+#include "OperatingSystemBase.h"
+#include "Clock.h"
+#include "Events.h"
+#include "Metrics.h"
+#include "Asserts.h"
+#include "GoldenState.h"
+#include "Log.h"
+
+// Internal Functions prototypes
+void Checkpoint_Blocks();
+int Checkpoint_BlockChanged(int);
+void Checkpoint_Taken(char *);
+int Checkpoint_Load(char *, int, SIMTIME *, int);
+void Checkpoint_Verify();
+void Checkpoint_WhatIf();
+void Checkpoint_WhatIfChild(char *, char *, int);
+int Checkpoint_Read(FILE *, void *, size_t);
+
+char defaultCheckpointFile[]="checkpoint.sim";
+SIMTIME checkpointAt=-1;
+char *checkpointFile=defaultCheckpointFile;
+int checkpointInterval=0;
+char *restoreFile="";
+char *verifyCheckpoint="";
+char *whatIf="";
+
+extern int registerPC_CPU;
+extern int registerAccumulator_CPU;
+extern BUSDATACELL registerIR_CPU;
+extern unsigned int registerPSW_CPU;
+extern int registerMAR_CPU;
+extern BUSDATACELL registerMBR_CPU;
+extern int registerCTRL_CPU;
+extern int registerA_CPU;
+extern int interruptLines_CPU;
+extern int interruptVectorTable[INTERRUPTTYPES];
+extern int registerBase_MMU;
+extern int registerLimit_MMU;
+extern int registerMAR_MMU;
+extern int registerCTRL_MMU;
+extern MEMORYCELL mainMemory[];
+extern int registerMAR_MainMemory;
+extern MEMORYCELL registerMBR_MainMemory;
+extern int registerCTRL_MainMemory;
+extern SIMTIME tics;
+extern int clockMode;
+extern int timerEvent;
+extern EVENT events[EVENTSMAXNUMBER];
+extern heapItem eventsQueue[EVENTSMAXNUMBER];
+extern int numberOfEventsInQueue;
+extern SIMTIME nextEventTime;
+extern unsigned int counter;
+extern PCB processTable[PROCESSTABLEMAXSIZE];
+extern int executingProcessID;
+extern int baseDaemonsInProgramList;
+extern heapItem readyToRunQueues[NUMBEROFQUEUES][PROCESSTABLEMAXSIZE];
+extern int numberOfReadyToRunProcesses[NUMBEROFQUEUES];
+extern int numberOfNotTerminatedUserProcesses;
+extern int numberOfSleepingProcesses;
+extern SIMTIME numberOfClockInterrupts;
+extern int tickless;
+extern int statusReportsSinceSnapshot;
+extern heapItem arrivalTimeQueue[PROGRAMSMAXNUMBER];
+extern int numberOfProgramsInArrivalTimeQueue;
+extern PROCESS_ACCOUNTING programAccounting[PROGRAMSMAXNUMBER];
+extern int processOfProgram[PROGRAMSMAXNUMBER];
+extern SIMTIME ticksWithoutProcess;
+extern SIMTIME numberOfContextSwitches;
+
+// Regions of the state, saved and restored as they are. A table is split in a block per entry
+typedef struct {
+	char *name;
+	void *address;
+	size_t size;
+	int entries;
+} CHECKPOINT_REGION;
+
+#define CHECKPOINT_REGION(variable) {#variable, &variable, sizeof(variable), 1}
+#define CHECKPOINT_TABLE(variable,entries) {#variable, variable, sizeof(variable), entries}
+
+CHECKPOINT_REGION checkpointRegions[]={
+	CHECKPOINT_REGION(registerPC_CPU),
+	CHECKPOINT_REGION(registerAccumulator_CPU),
+	CHECKPOINT_REGION(registerIR_CPU),
+	CHECKPOINT_REGION(registerPSW_CPU),
+	CHECKPOINT_REGION(registerMAR_CPU),
+	CHECKPOINT_REGION(registerMBR_CPU),
+	CHECKPOINT_REGION(registerCTRL_CPU),
+	CHECKPOINT_REGION(registerA_CPU),
+	CHECKPOINT_REGION(interruptLines_CPU),
+	CHECKPOINT_REGION(interruptVectorTable),
+	CHECKPOINT_REGION(registerBase_MMU),
+	CHECKPOINT_REGION(registerLimit_MMU),
+	CHECKPOINT_REGION(registerMAR_MMU),
+	CHECKPOINT_REGION(registerCTRL_MMU),
+	CHECKPOINT_REGION(registerMAR_MainMemory),
+	CHECKPOINT_REGION(registerMBR_MainMemory),
+	CHECKPOINT_REGION(registerCTRL_MainMemory),
+	CHECKPOINT_REGION(tics),
+	CHECKPOINT_REGION(clockMode),
+	CHECKPOINT_REGION(timerEvent),
+	CHECKPOINT_REGION(events),
+	CHECKPOINT_REGION(eventsQueue),
+	CHECKPOINT_REGION(numberOfEventsInQueue),
+	CHECKPOINT_REGION(nextEventTime),
+	CHECKPOINT_REGION(counter),
+	CHECKPOINT_TABLE(processTable,PROCESSTABLEMAXSIZE),
+	CHECKPOINT_REGION(executingProcessID),
+	CHECKPOINT_REGION(sipID),
+	CHECKPOINT_REGION(baseDaemonsInProgramList),
+	CHECKPOINT_REGION(readyToRunQueues),
+	CHECKPOINT_REGION(numberOfReadyToRunProcesses),
+	CHECKPOINT_REGION(numberOfNotTerminatedUserProcesses),
+	CHECKPOINT_REGION(sleepingProcessesQueue),
+	CHECKPOINT_REGION(numberOfSleepingProcesses),
+	CHECKPOINT_REGION(numberOfClockInterrupts),
+	CHECKPOINT_REGION(tickless),
+	CHECKPOINT_REGION(statusDirty),
+	CHECKPOINT_REGION(statusReportsSinceSnapshot),
+	CHECKPOINT_REGION(arrivalTimeQueue),
+	CHECKPOINT_REGION(numberOfProgramsInArrivalTimeQueue),
+	CHECKPOINT_REGION(programAccounting),
+	CHECKPOINT_REGION(processOfProgram),
+	CHECKPOINT_REGION(ticksWithoutProcess),
+	CHECKPOINT_REGION(numberOfContextSwitches),
+	{NULL, NULL, 0, 0}
+};
+
+// Blocks: the entries of the regions and then the pages of main memory
+typedef struct {
+	char *name;
+	int entry;		// In its table, -1 if not a table
+	void *address;
+	size_t size;
+	size_t copy;	// Regions: where the block is in checkpointCopy
+} CHECKPOINT_BLOCK;
+
+CHECKPOINT_BLOCK *checkpointBlocks=NULL;
+int numberOfCheckpointBlocks=0;
+int numberOfRegionBlocks=0;
+
+// Region blocks as they were in the last checkpoint, to find which ones have changed.
+// The pages of main memory tell it themselves (MainMemory_PageIsDirty)
+char *checkpointCopy=NULL;
+
+// The last checkpoint, the previous one of the next incremental checkpoint, and the
+// number of incremental checkpoints since the last full one
+char lastCheckpoint[CHECKPOINT_MAXNAME]="";
+int checkpointsInChain=0;
+SIMTIME nextCheckpointTick=0;
+
+// Verification against a checkpoint: its time (-1 until read), and the blocks different
+// (-1 if it has not been reached)
+SIMTIME verifyTime=-1;
+int verifyDifferences=-1;
+
+// What-ifs running, only in the process that forked them
+CHECKPOINT_WHATIF whatIfs[CHECKPOINT_MAXWHATIFS];
+int numberOfWhatIfs=0;
+
+// Option values must outlive the what-if that sets them
+char whatIfOptions[MAXLINELENGTH];
+char whatIfMetricsFile[CHECKPOINT_MAXNAME*2];
+
+// Called at the top of every instruction cycle, before the clock ticks: nothing is
+// half done there, so a restored simulation just enters the instruction cycle loop.
+// Returns 1 if the simulation has to stop there
+int Checkpoint_Check() {
+	SIMTIME now=Clock_GetTime();
+	char fileName[CHECKPOINT_MAXNAME];
+
+	if (verifyCheckpoint[0]!=0 && verifyDifferences<0) {
+		if (verifyTime<0)
+			Checkpoint_Verify();
+		else if (now>=verifyTime) {
+			Checkpoint_Verify();
+			Processor_ActivatePSW_Bit(POWEROFF_BIT);
+			return 1;
+		}
+	}
+	if (checkpointInterval>0 && now>=nextCheckpointTick) {
+		snprintf(fileName, sizeof(fileName), "%s.%lld", checkpointFile, now);
+		Checkpoint_Save(fileName, 1);
+		nextCheckpointTick=(now/checkpointInterval+1)*checkpointInterval;
+	}
+	if (checkpointAt>=0 && now>=checkpointAt) {
+		checkpointAt=-1;
+		if (Checkpoint_Save(checkpointFile, 0)==0 && whatIf[0]!=0)
+			Checkpoint_WhatIf();
+	}
+	return 0;
+}
+
+// Splits the regions in blocks, the first time they are needed
+void Checkpoint_Blocks() {
+	int i, entry, page, block=0;
+	size_t copySize=0;
+
+	if (checkpointBlocks!=NULL)
+		return;
+	for (i=0; checkpointRegions[i].name!=NULL; i++)
+		numberOfRegionBlocks+=checkpointRegions[i].entries;
+	numberOfCheckpointBlocks=numberOfRegionBlocks+MAINMEMORYPAGES;
+	checkpointBlocks=(CHECKPOINT_BLOCK *) malloc(numberOfCheckpointBlocks*sizeof(CHECKPOINT_BLOCK));
+	for (i=0; checkpointRegions[i].name!=NULL; i++)
+		for (entry=0; entry<checkpointRegions[i].entries; entry++, block++) {
+			checkpointBlocks[block].name=checkpointRegions[i].name;
+			checkpointBlocks[block].entry=checkpointRegions[i].entries>1 ? entry : -1;
+			checkpointBlocks[block].size=checkpointRegions[i].size/checkpointRegions[i].entries;
+			checkpointBlocks[block].address=(char *) checkpointRegions[i].address+entry*checkpointBlocks[block].size;
+			checkpointBlocks[block].copy=copySize;
+			copySize+=checkpointBlocks[block].size;
+		}
+	for (page=0; page<MAINMEMORYPAGES; page++, block++) {
+		checkpointBlocks[block].name="mainMemory page";
+		checkpointBlocks[block].entry=page;
+		checkpointBlocks[block].address=&mainMemory[page*MAINMEMORYPAGESIZE];
+		checkpointBlocks[block].size=(page==MAINMEMORYPAGES-1 ? MAINMEMORYSIZE-page*MAINMEMORYPAGESIZE : MAINMEMORYPAGESIZE)*sizeof(MEMORYCELL);
+	}
+	checkpointCopy=(char *) malloc(copySize);
+}
+
+// Has the block changed since the last checkpoint?
+int Checkpoint_BlockChanged(int block) {
+	if (block>=numberOfRegionBlocks)
+		return MainMemory_PageIsDirty(block-numberOfRegionBlocks);
+	return memcmp(checkpointBlocks[block].address, checkpointCopy+checkpointBlocks[block].copy, checkpointBlocks[block].size)!=0;
+}
+
+// The state now is the one of the checkpoint just written or restored
+void Checkpoint_Taken(char *fileName) {
+	int block;
+
+	for (block=0; block<numberOfRegionBlocks; block++)
+		memcpy(checkpointCopy+checkpointBlocks[block].copy, checkpointBlocks[block].address, checkpointBlocks[block].size);
+	MainMemory_ClearDirtyPages();
+	strncpy(lastCheckpoint, fileName, CHECKPOINT_MAXNAME-1);
+}
+
+// Writes a full checkpoint or, if there is a previous one to go on from, an incremental
+// one. Returns 0 if the checkpoint has been written
+int Checkpoint_Save(char *fileName, int incremental) {
+	FILE *stream;
+	SIMTIME now=Clock_GetTime();
+	char previous[CHECKPOINT_MAXNAME];
+	int i, length, block;
+
+	stream=fopen(fileName, "wb");
+	if (stream==NULL) {
+		ComputerSystem_DebugMessage(51,ERROR,fileName);
+		return -1;
+	}
+	Checkpoint_Blocks();
+	incremental=incremental && lastCheckpoint[0]!=0 && checkpointsInChain<CHECKPOINT_MAXCHAIN;
+	memset(previous, 0, sizeof(previous));
+	if (incremental)
+		strcpy(previous, lastCheckpoint);
+	fwrite(CHECKPOINT_MAGIC, 1, CHECKPOINT_MAGICLENGTH, stream);
+	fwrite(&now, sizeof(now), 1, stream);
+	fwrite(&numberOfCheckpointBlocks, sizeof(int), 1, stream);
+	fwrite(previous, 1, CHECKPOINT_MAXNAME, stream);
+	for (block=0; block<numberOfCheckpointBlocks; block++)
+		if (!incremental || Checkpoint_BlockChanged(block)) {
+			fwrite(&block, sizeof(int), 1, stream);
+			fwrite(&checkpointBlocks[block].size, sizeof(size_t), 1, stream);
+			fwrite(checkpointBlocks[block].address, 1, checkpointBlocks[block].size, stream);
+		}
+	block=-1;
+	fwrite(&block, sizeof(int), 1, stream);
+	for (i=0; i<PROGRAMSMAXNUMBER; i++) {
+		length=programList[i]==NULL ? -1 : strlen(programList[i]->executableName);
+		fwrite(&length, sizeof(length), 1, stream);
+		if (length<0)
+			continue;
+		fwrite(programList[i]->executableName, 1, length, stream);
+		fwrite(&programList[i]->arrivalTime, sizeof(SIMTIME), 1, stream);
+		fwrite(&programList[i]->type, sizeof(unsigned int), 1, stream);
+	}
+	if (fclose(stream)!=0) {
+		ComputerSystem_DebugMessage(51,ERROR,fileName);
+		return -1;
+	}
+	checkpointsInChain=incremental ? checkpointsInChain+1 : 0;
+	Checkpoint_Taken(fileName);
+	ComputerSystem_DebugMessage(50,SHUTDOWN,now,fileName);
+	return 0;
+}
+
+// Returns 1 if the bytes have been read
+int Checkpoint_Read(FILE *stream, void *address, size_t size) {
+	return fread(address, 1, size, stream)==size;
+}
+
+// Reads a checkpoint into the state, its previous ones first, and its program list if
+// programs. Returns 1 if it could be read; depth is the number of checkpoints after this
+// one in the chain
+int Checkpoint_Load(char *fileName, int depth, SIMTIME *time, int programs) {
+	FILE *stream;
+	char magic[CHECKPOINT_MAGICLENGTH];
+	char previous[CHECKPOINT_MAXNAME];
+	char name[MAXLINELENGTH];
+	SIMTIME previousTime;
+	size_t size;
+	int i, length, valid, numberOfBlocks, block;
+	PROGRAMS_DATA program;
+
+	stream=fopen(fileName, "rb");
+	valid=stream!=NULL
+		&& Checkpoint_Read(stream, magic, CHECKPOINT_MAGICLENGTH)
+		&& memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGICLENGTH)==0
+		&& Checkpoint_Read(stream, time, sizeof(SIMTIME))
+		&& Checkpoint_Read(stream, &numberOfBlocks, sizeof(int))
+		&& numberOfBlocks==numberOfCheckpointBlocks // Made by a simulator with other sizes
+		&& Checkpoint_Read(stream, previous, CHECKPOINT_MAXNAME);
+	if (valid && previous[0]!=0) {
+		previous[CHECKPOINT_MAXNAME-1]=0;
+		valid=depth<CHECKPOINT_MAXCHAIN && Checkpoint_Load(previous, depth+1, &previousTime, programs);
+	}
+	else
+		checkpointsInChain=depth;
+	while (valid && (valid=Checkpoint_Read(stream, &block, sizeof(int))) && block>=0)
+		valid=block<numberOfCheckpointBlocks
+			&& Checkpoint_Read(stream, &size, sizeof(size_t))
+			&& size==checkpointBlocks[block].size
+			&& Checkpoint_Read(stream, checkpointBlocks[block].address, size);
+	for (i=0; valid && i<PROGRAMSMAXNUMBER; i++) {
+		valid=Checkpoint_Read(stream, &length, sizeof(length)) && length<MAXLINELENGTH;
+		if (valid && length>=0)
+			valid=Checkpoint_Read(stream, name, length)
+				&& Checkpoint_Read(stream, &program.arrivalTime, sizeof(SIMTIME))
+				&& Checkpoint_Read(stream, &program.type, sizeof(unsigned int));
+		if (!valid || !programs)
+			continue;
+		// Only the entries of the command line or of a checkpoint are there, all allocated
+		if (programList[i]!=NULL) {
+			free(programList[i]->executableName);
+			free(programList[i]);
+			programList[i]=NULL;
+		}
+		if (length<0)
+			continue;
+		name[length]=0;
+		program.executableName=(char *) malloc((length+1)*sizeof(char));
+		strcpy(program.executableName, name);
+		programList[i]=(PROGRAMS_DATA *) malloc(sizeof(PROGRAMS_DATA));
+		*programList[i]=program;
+	}
+	if (stream!=NULL)
+		fclose(stream);
+	return valid;
+}
+
+// Brings the simulation to the state of the checkpoint, its program list too if programs.
+// A checkpoint that cannot be used leaves nothing to go on with. Returns its time
+SIMTIME Checkpoint_Restore(char *fileName, int programs) {
+	SIMTIME time;
+
+	Checkpoint_Blocks();
+	if (!Checkpoint_Load(fileName, 0, &time, programs)) {
+		ComputerSystem_DebugMessage(51,ERROR,fileName);
+		Simulator_FatalError(1);
+	}
+	// Periodic checkpoints of the restored simulation go on from this one
+	Checkpoint_Taken(fileName);
+	if (checkpointInterval>0)
+		nextCheckpointTick=(time/checkpointInterval+1)*checkpointInterval;
+	// Asserts up to the checkpoint were checked by the run that took it
+	Asserts_SkipAsserts(time);
+	GoldenState_StateRestored();
+	ComputerSystem_DebugMessage(52,POWERON,fileName,time);
+	return time;
+}
+
+// Size of the whole state, for copies of it kept in memory
+size_t Checkpoint_StateSize() {
+	size_t size=0;
+	int block;
+
+	Checkpoint_Blocks();
+	for (block=0; block<numberOfCheckpointBlocks; block++)
+		size+=checkpointBlocks[block].size;
+	return size;
+}
+
+// Copies the whole state into memory
+void Checkpoint_SaveState(char *state) {
+	int block;
+
+	Checkpoint_Blocks();
+	for (block=0; block<numberOfCheckpointBlocks; state+=checkpointBlocks[block++].size)
+		memcpy(state, checkpointBlocks[block].address, checkpointBlocks[block].size);
+}
+
+// Brings back a copy of the whole state. The last checkpoint taken and the pages written
+// since are not the ones of that state, so the next checkpoint is a full one
+void Checkpoint_RestoreState(char *state) {
+	int block;
+
+	Checkpoint_Blocks();
+	for (block=0; block<numberOfCheckpointBlocks; state+=checkpointBlocks[block++].size)
+		memcpy(checkpointBlocks[block].address, state, checkpointBlocks[block].size);
+	lastCheckpoint[0]=0;
+	checkpointsInChain=0;
+	GoldenState_StateRestored();
+}
+
+// The first call reads the time of the checkpoint to verify against. The second one,
+// when the simulation reaches it, compares the state with the one of the checkpoint
+void Checkpoint_Verify() {
+	FILE *stream;
+	char magic[CHECKPOINT_MAGICLENGTH];
+	char *state, name[CHECKPOINT_MAXNAME];
+	size_t size=0;
+	int block, valid;
+	SIMTIME time;
+
+	Checkpoint_Blocks();
+	if (verifyTime<0) {
+		stream=fopen(verifyCheckpoint, "rb");
+		valid=stream!=NULL
+			&& Checkpoint_Read(stream, magic, CHECKPOINT_MAGICLENGTH)
+			&& memcmp(magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGICLENGTH)==0
+			&& Checkpoint_Read(stream, &verifyTime, sizeof(SIMTIME));
+		if (stream!=NULL)
+			fclose(stream);
+		if (!valid) {
+			ComputerSystem_DebugMessage(51,ERROR,verifyCheckpoint);
+			Simulator_FatalError(1);
+		}
+		return;
+	}
+
+	// The checkpoint is loaded over the state, which is kept aside and put back after comparing
+	state=(char *) malloc(Checkpoint_StateSize());
+	Checkpoint_SaveState(state);
+	if (!Checkpoint_Load(verifyCheckpoint, 0, &time, 0)) {
+		ComputerSystem_DebugMessage(51,ERROR,verifyCheckpoint);
+		Simulator_FatalError(1);
+	}
+	verifyDifferences=0;
+	for (block=0, size=0; block<numberOfCheckpointBlocks; size+=checkpointBlocks[block++].size) {
+		if (memcmp(state+size, checkpointBlocks[block].address, checkpointBlocks[block].size)==0)
+			continue;
+		if (checkpointBlocks[block].entry<0)
+			snprintf(name, sizeof(name), "%s", checkpointBlocks[block].name);
+		else
+			snprintf(name, sizeof(name), "%s %d", checkpointBlocks[block].name, checkpointBlocks[block].entry);
+		ComputerSystem_DebugMessage(55,ERROR,verifyCheckpoint,name);
+		verifyDifferences++;
+		memcpy(checkpointBlocks[block].address, state+size, checkpointBlocks[block].size);
+	}
+	free(state);
+	ComputerSystem_DebugMessage(56,SHUTDOWN,verifyCheckpoint,time,verifyDifferences);
+}
+
+// Forks one child per value of the what-if option; the parent goes on as it was
+void Checkpoint_WhatIf() {
+	char *option, *values, *value;
+	int pid;
+
+	strncpy(whatIfOptions, whatIf, sizeof(whatIfOptions)-1);
+	option=strtok(whatIfOptions, "=");
+	values=strtok(NULL, "");
+	if (option==NULL || values==NULL) {
+		ComputerSystem_DebugMessage(53,ERROR,whatIf);
+		return;
+	}
+	// Nothing written so far may be written again by the children
+	Log_Flush();
+	fflush(NULL);
+	for (value=strtok(values, ","); value!=NULL && numberOfWhatIfs<CHECKPOINT_MAXWHATIFS; value=strtok(NULL, ",")) {
+		snprintf(whatIfs[numberOfWhatIfs].name, CHECKPOINT_MAXNAME, "%s=%s", option, value);
+		snprintf(whatIfs[numberOfWhatIfs].logFile, CHECKPOINT_MAXNAME*2, "%s.%s=%s", logFile, option, value);
+		pid=fork();
+		if (pid==0) {
+			Checkpoint_WhatIfChild(option, value, numberOfWhatIfs);
+			return;
+		}
+		if (pid<0) {
+			ComputerSystem_DebugMessage(53,ERROR,whatIfs[numberOfWhatIfs].name);
+			break;
+		}
+		whatIfs[numberOfWhatIfs++].pid=pid;
+	}
+}
+
+// The child sets its value and restarts the output into its own files
+void Checkpoint_WhatIfChild(char *option, char *value, int whatIfNumber) {
+	numberOfWhatIfs=0;
+	Simulator_SetOption(option, value);
+	logSink="file";
+	logFile=whatIfs[whatIfNumber].logFile;
+	if (metricsFile[0]!=0) {
+		snprintf(whatIfMetricsFile, sizeof(whatIfMetricsFile), "%s.%s", metricsFile, whatIfs[whatIfNumber].name);
+		metricsFile=whatIfMetricsFile;
+	}
+	Log_Restart();
+}
+
+// Waits for the what-ifs and shows how they ended. Returns the exit status of the
+// simulator: 2 if the state is not the one of the checkpoint to verify against
+int Checkpoint_Terminate() {
+	int i, status;
+
+	for (i=0; i<numberOfWhatIfs; i++) {
+		if (waitpid(whatIfs[i].pid, &status, 0)<0 || !WIFEXITED(status))
+			status=-1;
+		else
+			status=WEXITSTATUS(status);
+		ComputerSystem_DebugMessage(54,SHUTDOWN,whatIfs[i].name,whatIfs[i].logFile,status);
+	}
+	numberOfWhatIfs=0;
+	if (verifyCheckpoint[0]==0)
+		return 0;
+	if (verifyDifferences<0)
+		// The simulation has ended before
+		ComputerSystem_DebugMessage(57,ERROR,verifyCheckpoint);
+	return verifyDifferences!=0 ? 2 : 0;
+}
@@ -0,0 +1,57 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdio.h>
+#include "Simulator.h"
+
+// Checkpoint: the whole simulation (the machine, the OS tables, queues and counters,
+// the clock and its events, the accounting and the program list) is written into
+// checkpointFile at the top of the first instruction cycle at time checkpointAt or later,
+// and a later run restored from it goes on from that point. With checkpointInterval,
+// one is also written every checkpointInterval ticks into checkpointFile.<time>
+// The state is split in blocks: every variable, every PCB and every page of main memory.
+// A full checkpoint has all of them. An incremental one (the periodic ones after the
+// first) has only the blocks changed since the checkpoint before it, its previous one,
+// so a restore goes back through the previous ones down to a full one. A simulation can
+// also be stopped at the time of a checkpoint (verifyCheckpoint) to compare its state with it
+//   CHECKPOINT_MAGIC, time, number of blocks, name of the previous checkpoint (empty for
+//   a full one), the blocks as number, size and bytes up to number -1, and the program
+//   list: name length (-1 for an empty entry), name, arrival time and type
+#define CHECKPOINT_MAGIC "SIMCKPT\001"
+#define CHECKPOINT_MAGICLENGTH 8
+
+// Incremental checkpoints between two full ones
+#define CHECKPOINT_MAXCHAIN 64
+
+// What-ifs: once the checkpoint is taken, the simulator forks one child per value of an
+// option ("option=value1,value2,...") and every child goes on with its value, its output
+// into the log file with the option and the value as suffix
+#define CHECKPOINT_MAXWHATIFS 16
+#define CHECKPOINT_MAXNAME 128
+
+typedef struct {
+	int pid;
+	char name[CHECKPOINT_MAXNAME];		// option=value
+	char logFile[CHECKPOINT_MAXNAME*2];
+} CHECKPOINT_WHATIF;
+
+// Functions prototypes
+int Checkpoint_Check();
+int Checkpoint_Save(char *, int);
+SIMTIME Checkpoint_Restore(char *, int);
+int Checkpoint_Terminate();
+size_t Checkpoint_StateSize();
+void Checkpoint_SaveState(char *);
+void Checkpoint_RestoreState(char *);
+
+// Time of the checkpoint (none if negative) and its file, ticks between periodic
+// checkpoints (none if 0), checkpoint to restore, checkpoint to verify against and
+// what-ifs (none if empty)
+extern SIMTIME checkpointAt;
+extern char *checkpointFile;
+extern int checkpointInterval;
+extern char *restoreFile;
+extern char *verifyCheckpoint;
+extern char *whatIf;
+
+#endif
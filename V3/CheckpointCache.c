@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <dirent.h>
+#include "CheckpointCache.h"
+#include "Checkpoint.h"
+#include "ComputerSystem.h"
+#include "ComputerSystemBase.h"
+#include "Clock.h"
+#include "Events.h"
+#include "Heap.h"
+#include "Asserts.h"
+
+// Internal Functions prototypes
+unsigned long long CheckpointCache_Fingerprint(SIMTIME);
+SIMTIME CheckpointCache_NextArrival(SIMTIME);
+SIMTIME CheckpointCache_Find(SIMTIME, char *);
+void CheckpointCache_Arrivals(SIMTIME);
+
+char *checkpointCache="";
+
+extern int initialPID;
+extern int tickless;
+extern heapItem arrivalTimeQueue[];
+extern int numberOfProgramsInArrivalTimeQueue;
+
+// Arrival whose checkpoint is the next to write (none if negative)
+SIMTIME nextCacheArrival=-1;
+
+// The executable of the simulator, hashed once
+unsigned long long simulatorHash=0;
+
+// FNV-1a of some bytes, going on from a previous hash
+unsigned long long CheckpointCache_Hash(unsigned long long hash, const void *data, size_t size) {
+	const unsigned char *bytes=(const unsigned char *) data;
+
+	while (size-->0) {
+		hash^=*bytes++;
+		hash*=CHECKPOINTCACHE_FNVPRIME;
+	}
+	return hash;
+}
+
+// Hash of the contents of a file (of nothing if it cannot be read)
+unsigned long long CheckpointCache_HashFile(char *fileName) {
+	unsigned long long hash=CHECKPOINTCACHE_FNVBASIS;
+	char buffer[4096];
+	size_t length;
+	FILE *stream=fopen(fileName, "rb");
+
+	if (stream==NULL)
+		return hash;
+	while ((length=fread(buffer, 1, sizeof(buffer), stream))>0)
+		hash=CheckpointCache_Hash(hash, buffer, length);
+	fclose(stream);
+	return hash;
+}
+
+// Fingerprint of the simulation before the programs arriving at arrival or later
+unsigned long long CheckpointCache_Fingerprint(SIMTIME arrival) {
+	unsigned long long hash=CHECKPOINTCACHE_FNVBASIS, fileHash;
+	int i;
+
+	if (simulatorHash==0)
+		simulatorHash=CheckpointCache_HashFile("/proc/self/exe");
+	hash=CheckpointCache_Hash(hash, &simulatorHash, sizeof(simulatorHash));
+	hash=CheckpointCache_Hash(hash, &initialPID, sizeof(initialPID));
+	hash=CheckpointCache_Hash(hash, &intervalBetweenInterrupts, sizeof(intervalBetweenInterrupts));
+	hash=CheckpointCache_Hash(hash, &tickless, sizeof(tickless));
+	fileHash=CheckpointCache_HashFile("OperatingSystemCode");
+	hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	fileHash=CheckpointCache_HashFile(ASSERTS_FILE);
+	hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	for (i=0; i<PROGRAMSMAXNUMBER && programList[i]!=NULL; i++) {
+		hash=CheckpointCache_Hash(hash, &programList[i]->type, sizeof(programList[i]->type));
+		// Programs arriving later only count
+		if (programList[i]->arrivalTime>=arrival)
+			continue;
+		hash=CheckpointCache_Hash(hash, programList[i]->executableName, strlen(programList[i]->executableName)+1);
+		hash=CheckpointCache_Hash(hash, &programList[i]->arrivalTime, sizeof(programList[i]->arrivalTime));
+		fileHash=CheckpointCache_HashFile(programList[i]->executableName);
+		hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	}
+	return CheckpointCache_Hash(hash, &i, sizeof(i));
+}
+
+// First arrival after time (none if negative)
+SIMTIME CheckpointCache_NextArrival(SIMTIME time) {
+	SIMTIME next=-1;
+	int i;
+
+	for (i=0; i<PROGRAMSMAXNUMBER && programList[i]!=NULL; i++)
+		if (programList[i]->arrivalTime>time && (next<0 || programList[i]->arrivalTime<next))
+			next=programList[i]->arrivalTime;
+	return next;
+}
+
+// Latest checkpoint of the cache usable before the programs arriving at arrival or later.
+// Returns its time (none if negative) and its file (PATH_MAX long)
+SIMTIME CheckpointCache_Find(SIMTIME arrival, char *fileName) {
+	char prefix[32], name[PATH_MAX];
+	int prefixLength, length;
+	SIMTIME time, latest=-1;
+	DIR *dir;
+	struct dirent *entry;
+
+	prefixLength=snprintf(prefix, sizeof(prefix), "%016llx.", CheckpointCache_Fingerprint(arrival));
+	dir=opendir(checkpointCache);
+	if (dir==NULL)
+		return -1;
+	while ((entry=readdir(dir))!=NULL) {
+		if (strncmp(entry->d_name, prefix, prefixLength)!=0
+		 || sscanf(&entry->d_name[prefixLength], "%lld%n", &time, &length)!=1
+		 || strcmp(&entry->d_name[prefixLength+length], CHECKPOINTCACHE_SUFFIX)!=0
+		 || time>=arrival || time<=latest)
+			continue;
+		// Files whose path does not fit are not used
+		length=snprintf(name, sizeof(name), "%s/%s", checkpointCache, entry->d_name);
+		if (length<0 || length>=(int) sizeof(name))
+			continue;
+		latest=time;
+		strcpy(fileName, name);
+	}
+	closedir(dir);
+	return latest;
+}
+
+// Called after the OS initialization: goes on from the latest usable checkpoint
+void CheckpointCache_Restore() {
+	char fileName[PATH_MAX], latestFileName[PATH_MAX];
+	SIMTIME arrival, time, latest=-1;
+
+	if (checkpointCache[0]==0)
+		return;
+	for (arrival=CheckpointCache_NextArrival(0); arrival>=0; arrival=CheckpointCache_NextArrival(arrival)) {
+		time=CheckpointCache_Find(arrival, fileName);
+		if (time>latest) {
+			latest=time;
+			strcpy(latestFileName, fileName);
+		}
+	}
+	if (latest>=0) {
+		// The program list of this run is kept
+		Checkpoint_Restore(latestFileName, 0);
+		CheckpointCache_Arrivals(latest);
+	}
+	nextCacheArrival=CheckpointCache_NextArrival(latest<0 ? 0 : latest);
+}
+
+// The programs arriving after the checkpoint are the ones of this run, not the ones
+// of the run that took it
+void CheckpointCache_Arrivals(SIMTIME time) {
+	int id;
+
+	for (id=0; id<EVENTSMAXNUMBER; id++)
+		if (events[id].type==EVENT_ARRIVAL && programList[events[id].info]->arrivalTime>time)
+			Events_Reschedule(id, programList[events[id].info]->arrivalTime);
+	Heap_Rebuild(arrivalTimeQueue, QUEUE_ARRIVAL, numberOfProgramsInArrivalTimeQueue);
+}
+
+// Called at the top of every instruction cycle: at the last top before an arrival, its
+// checkpoint is written unless the cache has it. Which top is the last one is only known
+// afterwards, so every top close enough to the arrival writes it, in place of the one
+// written at the top before
+void CheckpointCache_Check() {
+	char fileName[PATH_MAX];
+	unsigned long long fingerprint;
+	SIMTIME now, time;
+	int length;
+
+	if (checkpointCache[0]==0 || nextCacheArrival<0)
+		return;
+	now=Clock_GetTime();
+	while (nextCacheArrival>=0 && nextCacheArrival<=now)
+		nextCacheArrival=CheckpointCache_NextArrival(nextCacheArrival);
+	if (nextCacheArrival<0 || nextCacheArrival-now>CHECKPOINTCACHE_CYCLETICKS)
+		return;
+	fingerprint=CheckpointCache_Fingerprint(nextCacheArrival);
+	length=snprintf(fileName, sizeof(fileName), "%s/%016llx.%lld%s", checkpointCache,
+		fingerprint, now, CHECKPOINTCACHE_SUFFIX);
+	// A checkpoint whose path does not fit is not written
+	if (length<0 || length>=(int) sizeof(fileName))
+		return;
+	if (access(fileName, F_OK)!=0 && Checkpoint_Save(fileName, 0)!=0)
+		return;
+	// The same fingerprint is the same simulation up to the arrival: the checkpoints
+	// at the tops before this one were not the last ones
+	for (time=nextCacheArrival-CHECKPOINTCACHE_CYCLETICKS; time<now; time++) {
+		snprintf(fileName, sizeof(fileName), "%s/%016llx.%lld%s", checkpointCache,
+			fingerprint, time, CHECKPOINTCACHE_SUFFIX);
+		unlink(fileName);
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef CHECKPOINTCACHE_H
+#define CHECKPOINTCACHE_H
+
+#include "Simulator.h"
+
+// Checkpoint cache: with checkpointCache (a directory), a full checkpoint is written at
+// the last instruction cycle top before every program arrival, named after a fingerprint
+// of everything the simulation depends on up to then: the simulator, the settings
+// changing it, the operating system and asserts files, the number and type of the
+// programs and, for the ones arriving before, their names, arrival times and contents.
+// A later run with the same fingerprint before one of its arrivals goes on from the
+// latest such checkpoint taken before it, with its own programs arriving from then on
+//   <checkpointCache>/<fingerprint>.<time>.sim
+#define CHECKPOINTCACHE_SUFFIX ".sim"
+
+// Most ticks from the top of an instruction cycle to the next one: the fetch and an
+// entry into the OS
+#define CHECKPOINTCACHE_CYCLETICKS 2
+
+// Fingerprints are FNV-1a hashes
+#define CHECKPOINTCACHE_FNVBASIS 0xcbf29ce484222325ULL
+#define CHECKPOINTCACHE_FNVPRIME 0x100000001b3ULL
+
+// Functions prototypes
+void CheckpointCache_Restore();
+void CheckpointCache_Check();
+unsigned long long CheckpointCache_Hash(unsigned long long, const void *, size_t);
+unsigned long long CheckpointCache_HashFile(char *);
+
+// Directory of the cache (none if empty)
+extern char *checkpointCache;
+
+#endif
@@ -2,32 +2,85 @@
 #include "Processor.h"
 #include "ComputerSystemBase.h"
 #include "OperatingSystemBase.h"
+#include "Events.h"
 #ifndef DEFAULT_INTERVAL_BETWEEN_INTERRUPTS
 	#define DEFAULT_INTERVAL_BETWEEN_INTERRUPTS 5
 #endif
 
-int tics=0;
+SIMTIME tics=0;
 
+// Periodic interrupts or one-shot timer
+int clockMode=CLOCK_PERIODIC;
+
+// Pending timer event into the simulation events queue (-1 if none)
+int timerEvent=-1;
+
+// Time advances here (or in Clock_Advance): between two events this is just a comparison
 void Clock_Update()
 {
-	if(intervalBetweenInterrupts > 0)
-	{
-		intervalBetweenInterrupts--;
-	}	
-	else
-	{
-		Processor_RaiseInterrupt(CLOCKINT_BIT);
-		intervalBetweenInterrupts = DEFAULT_INTERVAL_BETWEEN_INTERRUPTS;
-	}
-
 	tics++;
+	if (tics>=Events_NextEventTime())
+		Events_Dispatch(tics);
 	
     // ComputerSystem_DebugMessage(97,CLOCK,tics);
 
 }
 
+// A tick known to come before the next event (see Wrappers_RunUntilNextEvent)
+void Clock_Advance()
+{
+	tics++;
+}
+
 
-int Clock_GetTime() 
+SIMTIME Clock_GetTime() 
 {
 	return tics;
 }
+
+// Starts periodic interrupts
+void Clock_Initialize()
+{
+	Clock_SetMode(CLOCK_PERIODIC);
+}
+
+// Clock ticks between two periodic interrupts
+int Clock_GetPeriod()
+{
+	return intervalBetweenInterrupts+1;
+}
+
+// Selects periodic interrupts or the one-shot timer (initially disarmed)
+void Clock_SetMode(int mode)
+{
+	clockMode=mode;
+	Events_Cancel(timerEvent);
+	timerEvent=-1;
+	if (clockMode==CLOCK_PERIODIC)
+		timerEvent=Events_Schedule(tics+Clock_GetPeriod(), EVENT_TIMER, 0);
+}
+
+int Clock_GetMode()
+{
+	return clockMode;
+}
+
+// Arms the one-shot timer to raise a clock interrupt when the clock reaches the given
+// time (at the next tick if it has already passed). A negative time disarms it
+void Clock_SetTimer(SIMTIME time)
+{
+	Events_Cancel(timerEvent);
+	timerEvent=-1;
+	if (time>=0)
+		timerEvent=Events_Schedule(time>tics?time:tics+1, EVENT_TIMER, 0);
+}
+
+// The timer event has come: a periodic timer programs itself again,
+// a one-shot timer must be programmed again for the next interrupt
+void Clock_TimerEvent()
+{
+	timerEvent=-1;
+	Processor_RaiseInterrupt(CLOCKINT_BIT);
+	if (clockMode==CLOCK_PERIODIC)
+		timerEvent=Events_Schedule(tics+Clock_GetPeriod(), EVENT_TIMER, 0);
+}
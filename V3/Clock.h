@@ -1,8 +1,21 @@
 #ifndef Clock_H
 #define Clock_H
 
+#include "Simulator.h"
+
+// Clock working modes
+#define CLOCK_PERIODIC 0
+#define CLOCK_ONESHOT 1
+
 // Functions prototypes
 void Clock_Update();
-int Clock_GetTime();
+void Clock_Advance();
+SIMTIME Clock_GetTime();
+void Clock_Initialize();
+int Clock_GetPeriod();
+void Clock_SetMode(int);
+int Clock_GetMode();
+void Clock_SetTimer(SIMTIME);
+void Clock_TimerEvent();
 
 #endif
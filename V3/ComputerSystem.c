@@ -7,6 +7,14 @@
 #include "Messages.h"
 #include "Asserts.h"
 #include "Wrappers.h"
+#include "Clock.h"
+#include "Metrics.h"
+#include "Log.h"
+#include "FlightRecorder.h"
+#include "GoldenState.h"
+#include "StateHash.h"
+#include "Checkpoint.h"
+#include "CheckpointCache.h"
 
 // Functions prototypes
 void ComputerSystem_PrintProgramList();
@@ -17,31 +25,46 @@ PROGRAMS_DATA *programList[PROGRAMSMAXNUMBER];
 heapItem arrivalTimeQueue[PROGRAMSMAXNUMBER];
 int numberOfProgramsInArrivalTimeQueue = 0;
 
-// Students messages 
-char STUDENT_MESSAGES_FILE[MAXIMUMLENGTH]="messagesSTD.txt";
+// Students messages, read at run time only when given with --messagesSTDFile
+// (the messages files are compiled into the simulator)
+char STUDENT_MESSAGES_FILE[MAXIMUMLENGTH]="";
 
 // Powers on of the Computer System.
 void ComputerSystem_PowerOn(int argc, char *argv[], int paramIndex) {
 
+	// Start the output pipeline
+	Log_Initialize();
+	FlightRecorder_Initialize();
+
 	// Obtain a list of programs in the command line
 	int daemonsBaseIndex = ComputerSystem_ObtainProgramList(argc, argv, paramIndex);
 
 	// Load debug messages
-	int nm=0;
-	nm=Messages_Load_Messages(nm,TEACHER_MESSAGES_FILE);
-	if (nm<0) {
-		ComputerSystem_DebugMessage(64,SHUTDOWN,TEACHER_MESSAGES_FILE);
-		exit(2);
-	}
-	nm=Messages_Load_Messages(nm,STUDENT_MESSAGES_FILE);
+	int nm=Messages_LoadCatalogue();
+	if (STUDENT_MESSAGES_FILE[0]!=0)
+		nm=Messages_Load_Messages(nm,STUDENT_MESSAGES_FILE);
 	ComputerSystem_PrintProgramList();
 
+	// Start the clock interrupts
+	Clock_Initialize();
+
 	// Prepare if necesary the assert system
 	Asserts_LoadAsserts();
 
-	// Request the OS to do the initial set of tasks. The last one will be
-	// the processor allocation to the process with the highest priority
-	OperatingSystem_Initialize(daemonsBaseIndex);
+	// A restored simulation goes on from its checkpoint instead of starting the OS
+	if (restoreFile[0]!=0)
+		Checkpoint_Restore(restoreFile, 1);
+	else {
+		// Request the OS to do the initial set of tasks. The last one will be
+		// the processor allocation to the process with the highest priority
+		OperatingSystem_Initialize(daemonsBaseIndex);
+		// A workload beginning as a previous one goes on from where they part
+		CheckpointCache_Restore();
+	}
+
+	// Golden state capture or verification, if requested
+	GoldenState_Initialize();
+	StateHash_Initialize();
 	
 	// Tell the processor to begin its instruction cycle 
 	Processor_InstructionCycleLoop();
@@ -50,9 +73,18 @@ void ComputerSystem_PowerOn(int argc, char *argv[], int paramIndex) {
 
 // Powers off the CS (the C program ends)
 void ComputerSystem_PowerOff() {
+	// Write the accounting report, if requested
+	Metrics_WriteReport();
+	// Result of the golden state verification, if requested
+	GoldenState_Terminate();
+	StateHash_Terminate();
+	// What-ifs forked from a checkpoint and verification against a checkpoint, if requested
+	int status=Checkpoint_Terminate();
 	// Show message in red colour: "END of the simulation\n" 
 	ComputerSystem_DebugMessage(99,SHUTDOWN,"END of the simulation\n"); 
-	exit(0);
+	// Pending output reaches its sink before the end
+	Log_Terminate();
+	exit(status);
 }
 
 /////////////////////////////////////////////////////////
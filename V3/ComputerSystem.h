@@ -34,7 +34,7 @@ void ComputerSystem_PowerOff();
 // Daemon programs of type DAEMONPROGRAM
 typedef struct ProgramData {
     char *executableName;
-    unsigned int arrivalTime;
+    SIMTIME arrivalTime;
     unsigned int type;
 } PROGRAMS_DATA;
 
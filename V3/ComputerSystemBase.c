@@ -10,9 +10,15 @@
 #include "Messages.h"
 #include "Asserts.h"
 #include "Clock.h"
+#include "Events.h"
+#include "Log.h"
+#include "BinaryLog.h"
 
 // Functions prototypes
-
+int ComputerSystem_ParseTraceFilter(char *);
+int ComputerSystem_ParseTraceList(char *, unsigned char [], int);
+void ComputerSystem_EmitDebugMessage(int, char, int, va_list);
+void ComputerSystem_WriteTimeStamp(char, int, int);
 
 extern int GEN_ASSERTS;
 
@@ -22,10 +28,31 @@ char defaultDebugLevel[]="A";
 // related to them
 char *debugLevel=defaultDebugLevel;
 
-int endSimulationTime=-1; // For end simulation forced by time
+// Sections of debugLevel as a bitmask, computed once. ERROR messages are always shown
+unsigned int debugSectionsMask=~0u;
+
+SIMTIME endSimulationTime=-1; // For end simulation forced by time
 
 int intervalBetweenInterrupts = DEFAULT_INTERVAL_BETWEEN_INTERRUPTS; // Default value
 
+// Trace filter given with --traceFilter, as "pid=1,3-5;tick=100-200;msg=110-111;sections=ps".
+// Messages not passing it are discarded before being formatted
+char *traceFilterExpression=NULL;
+struct {
+	int active;
+	int byPID, byMessage;
+	SIMTIME fromTick, toTick; // toTick -1 for no end
+	unsigned char PIDs[PROCESSTABLEMAXSIZE];
+	unsigned char messages[MSGMAXNUMBER];
+} traceFilter={0, 0, 0, 0, -1};
+
+// With a trace filter, the time at the beginning of a line waits for the first
+// message of the line that passes the filter
+int traceTimePending=0;
+char traceTimeSection;
+int traceTimeIndented, traceTimeKernel;
+int traceTimeWriting=0;
+
 // Only one colour messages. Set to 1 for more colours checking uppercase in debugLevel
 int COLOURED = 0 ;
 
@@ -50,12 +77,19 @@ int ComputerSystem_ObtainProgramList(int argc, char *argv[], int paramIndex) {
 	}
 
 	// To remember the simulator sections to be message-debugged
+	debugSectionsMask=ComputerSystem_SectionBit(ERROR);
 	for (i=0; i< strlen(debugLevel);i++) {
 	  if (isupper(debugLevel[i])){
 		COLOURED = 1;
 		debugLevel[i]=tolower(debugLevel[i]);
 	  }
+	  if (debugLevel[i]==ALL)
+		debugSectionsMask=~0u;
+	  else if (debugLevel[i]>='a' && debugLevel[i]<='z')
+		debugSectionsMask|=ComputerSystem_SectionBit(debugLevel[i]);
 	}
+	if (traceFilterExpression!=NULL && ComputerSystem_ParseTraceFilter(traceFilterExpression)<0)
+		Log_Printf(ERROR,"Invalid trace filter [%s], ignored\n",traceFilterExpression);
 
 	// Store the names of the programs
 	for (i = paramIndex; i < argc && count<PROGRAMSMAXNUMBER;) { // check number of programs < PROGRAMSMAXNUMBER
@@ -68,7 +102,7 @@ int ComputerSystem_ObtainProgramList(int argc, char *argv[], int paramIndex) {
 		progData->arrivalTime = 0;
 		// Try to store the arrival time if exists
 		if ((i < argc)
-			 && (sscanf(argv[i], "%d", &(progData->arrivalTime)) == 1)) {
+			 && (sscanf(argv[i], "%lld", &(progData->arrivalTime)) == 1)) {
 				// An arrival time has been read. Increment i
 				i++;
 			 }
@@ -84,132 +118,187 @@ int ComputerSystem_ObtainProgramList(int argc, char *argv[], int paramIndex) {
 }
 
 // Function used to show messages with details of the internal working of
-// the simulator
+// the simulator. The message is about the executing process
 // IT IS NOT NECESSARY TO UNDERSTAND ALL THE DETAILS OF THIS FUNCTION
 void ComputerSystem_DebugMessage(int msgNo, char section, ...) {
 
 	va_list lp;
-	char c, *format;
-	int count, youHaveToContinue, colour=0;
- 
-	int pos;
-	
+
+	// Nothing to do for sections not shown
+	if (!ComputerSystem_IsDebugEnabled(section))
+		return;
+	va_start(lp, section);
+	ComputerSystem_EmitDebugMessage(msgNo, section, OperatingSystem_GetExecutingProcess(), lp);
+	va_end(lp);
+}
+
+// The same for a message about a given process, for the trace filter
+void ComputerSystem_ProcessDebugMessage(int PID, int msgNo, char section, ...) {
+
+	va_list lp;
+
+	if (!ComputerSystem_IsDebugEnabled(section))
+		return;
+	va_start(lp, section);
+	ComputerSystem_EmitDebugMessage(msgNo, section, PID, lp);
+	va_end(lp);
+}
+
+void ComputerSystem_EmitDebugMessage(int msgNo, char section, int PID, va_list lp) {
+
+	int i, pos;
+	SIMTIME tick;
+	DEBUG_MESSAGES *message;
+	MESSAGE_ARG args[MSGMAXIMUMLENGTH];
+
+	if (traceFilter.active && !traceTimeWriting) {
+		tick=Clock_GetTime();
+		if ((traceFilter.byPID && (PID<0 || PID>=PROCESSTABLEMAXSIZE || !traceFilter.PIDs[PID]))
+			|| (traceFilter.byMessage && (msgNo<0 || msgNo>=MSGMAXNUMBER || !traceFilter.messages[msgNo]))
+			|| tick<traceFilter.fromTick || (traceFilter.toTick>=0 && tick>traceFilter.toTick))
+			return;
+		// The line begins with this message: its time goes first
+		if (traceTimePending && traceTimeSection==section)
+			ComputerSystem_WriteTimeStamp(section, traceTimeIndented, traceTimeKernel);
+		traceTimePending=0;
+	}
+
         pos=Messages_Get_Pos(msgNo);
         if (pos==-1) {
-         printf("Debug Message %d not defined\n",msgNo);
+         Log_Printf(section,"Debug Message %d not defined\n",msgNo);
          return;
         }
-        format=DebugMessages[pos].format;
+        message=&DebugMessages[pos];
         	
-	va_start(lp, section);
-	
-	if ((strchr(debugLevel, ALL) != NULL) 		// Print the message because the user specified ALL
-	  || section == ERROR  						//  Always print ERROR section
-	  || (strchr(debugLevel,section)) != NULL){ //  or the section argument is included in the debugLevel string
-		
-		for (count = 0, youHaveToContinue = 1; youHaveToContinue == 1; count++) {
-			//printf("(%c)",format[count]);
-			switch (format[count]) {
-				case '\\':count++;
-				 	 switch (format[count]) {
-						case 'n': printf("\n");
-							  break;
-						case 't': printf("\t");	
-							  break;
-						default: printf("\%c", format[count]);
-					} // switch Control Chars
-					break;
-				// case '%':			
-				case '@':	// Next color char		
-		 			count++;
-					switch (format[count]) {
-			 			case 'R': // Text in red
-							if (COLOURED){
-							  printf("%c[%d;%dm", 0x1B, 1, 31);
-							  if (!colour) colour=1;
-							}
-						break;
-						case 'G': // Text in green
-							if (COLOURED){
-						  	printf("%c[%d;%dm", 0x1B, 1, 32);
-						  	if (!colour) colour=1;
-							}
-							break;
-						case 'Y': // Text in yellow
-		  					if (COLOURED){
-							  printf("%c[%d;%dm", 0x1B, 1, 33);
-							  if (!colour) colour=1;
-							}
-							break;
-						case 'B': // Text in blue
-							if (COLOURED){
-							  printf("%c[%d;%dm", 0x1B, 1, 34);
-						  	if (!colour) colour=1;
-							}
-							break;
-						case 'M': // // Text in magenta
-							if (COLOURED){
-						  	printf("%c[%d;%dm", 0x1B, 1, 35);
-						  	if (!colour) colour=1;
-							}
-							break;
-						case 'C': // Text in cyan
-							if (COLOURED){
-							  printf("%c[%d;%dm", 0x1B, 1, 36);
-							  if (!colour) colour=1;
-							}
-							break;		
-						case 'W': // Text in white
-							if (COLOURED){
-							  printf("%c[%d;%dm", 0x1B, 1, 37);
-							  if (!colour) colour=1;
-							}
-							break;
-						case '@': // Text without color
-							if (COLOURED && colour)
-							    printf("%c[%dm", 0x1B, 0);
-							break;	
-					}	// switch colors chars
-					break;
-				case '%':			
-		 			count++;
-					switch (format[count]) {
-						case 's':
-							printf("%s",va_arg(lp, char *));
-							break;
-						case 'd':
-							printf("%d",va_arg(lp, int));
-							break;
-						case 'f':
-							printf("%f",va_arg(lp, double));
-							break;
-						case 'c':
-							c = (char) va_arg(lp, int);
-							printf("%c", c);
-							break;
-						case 'x':
-							printf("%04X", va_arg(lp, int));
-							break;
-						default:
-							youHaveToContinue = 0;
-						} // switch format chars
-					break;
-				default:if (format[count]==0)
-						youHaveToContinue=0;
-					else
-						printf("%c",format[count]);				
-			} // switch
-		} // for
-		va_end(lp);
-	} // if
-	if (COLOURED && colour)
-	    printf("%c[%dm", 0x1B, 0);
+	// Arguments are taken as the compiled message expects them
+	for (i=0; i<message->numberOfArguments; i++)
+		switch (message->argumentTypes[i]) {
+			case ARGUMENT_STRING:
+				args[i].s=va_arg(lp, char *);
+				break;
+			case ARGUMENT_SIMTIME:
+				args[i].l=va_arg(lp, SIMTIME);
+				break;
+			case ARGUMENT_DOUBLE:
+				args[i].f=va_arg(lp, double);
+				break;
+			default: // int, char and hexadecimal values
+				args[i].d=va_arg(lp, int);
+		}
+
+	if (logBinary) // Raw values, rendered offline by simlog
+		BinaryLog_Message(msgNo, pos, args, section, COLOURED, Clock_GetTime(), PID);
+	else
+		Messages_Write(pos, COLOURED, args, section);
 } // ComputerSystem_DebugMessage()
 
+// Time at the beginning of a line, after a tab in kernel mode if indented. With a
+// trace filter it is written with the first message of the line passing the filter
+void ComputerSystem_TimeStamp(char section, int indented) {
+	int kernel=Processor_PSW_BitState(EXECUTION_MODE_BIT);
+
+	if (traceFilter.active) {
+		traceTimePending=1;
+		traceTimeSection=section;
+		traceTimeIndented=indented;
+		traceTimeKernel=kernel;
+	}
+	else
+		ComputerSystem_WriteTimeStamp(section, indented, kernel);
+}
+
+void ComputerSystem_WriteTimeStamp(char section, int indented, int kernel) {
+	traceTimeWriting=1;
+	if (indented)
+		ComputerSystem_DebugMessage(100,section,kernel?"\t":"");
+	ComputerSystem_DebugMessage(kernel?95:94,section,Clock_GetTime());
+	traceTimeWriting=0;
+}
+
 // Función equivalente a OperationgSystem_ShowTime en ComputerSystem
 // No tabula al principio
 void ComputerSystem_ShowTime(char section) {
-      ComputerSystem_DebugMessage(Processor_PSW_BitState(EXECUTION_MODE_BIT)?95:94,section,Clock_GetTime());
+      if (ComputerSystem_IsDebugEnabled(section))
+        ComputerSystem_TimeStamp(section, 0);
+}
+
+// Parses the trace filter. Returns 0/-1 ok/wrong expression
+int ComputerSystem_ParseTraceFilter(char *expression) {
+	char *copy, *clause, *value, *nextClause;
+	unsigned int sectionsMask=0;
+	int i, fields, rc=0;
+
+	copy=(char *) malloc((strlen(expression)+1)*sizeof(char));
+	strcpy(copy,expression);
+	for (clause=copy; clause!=NULL && rc==0; clause=nextClause) {
+		nextClause=strchr(clause,';');
+		if (nextClause!=NULL)
+			*nextClause++=0;
+		if (clause[0]==0)
+			continue;
+		value=strchr(clause,'=');
+		if (value==NULL) {
+			rc=-1;
+			break;
+		}
+		*value++=0;
+		if (strcmp(clause,"pid")==0) {
+			rc=ComputerSystem_ParseTraceList(value, traceFilter.PIDs, PROCESSTABLEMAXSIZE);
+			traceFilter.byPID=1;
+		}
+		else if (strcmp(clause,"msg")==0) {
+			rc=ComputerSystem_ParseTraceList(value, traceFilter.messages, MSGMAXNUMBER);
+			traceFilter.byMessage=1;
+		}
+		else if (strcmp(clause,"tick")==0) {
+			// from-to, from- or a single tick
+			fields=sscanf(value,"%lld-%lld",&traceFilter.fromTick,&traceFilter.toTick);
+			if (fields<1 || traceFilter.fromTick<0)
+				rc=-1;
+			else if (fields==1)
+				traceFilter.toTick=strchr(value,'-')!=NULL ? -1 : traceFilter.fromTick;
+			else if (traceFilter.toTick<traceFilter.fromTick)
+				rc=-1;
+		}
+		else if (strcmp(clause,"sections")==0) {
+			for (i=0; value[i]!=0; i++)
+				if (tolower(value[i])==ALL)
+					sectionsMask=~0u;
+				else if (tolower(value[i])>='a' && tolower(value[i])<='z')
+					sectionsMask|=ComputerSystem_SectionBit(tolower(value[i]));
+				else
+					rc=-1;
+			// Only some of the sections selected with --debugSections
+			debugSectionsMask&=sectionsMask | ComputerSystem_SectionBit(ERROR);
+		}
+		else
+			rc=-1;
+	}
+	free(copy);
+	traceFilter.active=rc==0 && (traceFilter.byPID || traceFilter.byMessage || traceFilter.fromTick>0 || traceFilter.toTick>=0);
+	return rc;
+}
+
+// Marks the numbers of a list like "1,3-5" lower than size. Returns 0/-1 ok/wrong list
+int ComputerSystem_ParseTraceList(char *list, unsigned char marks[], int size) {
+	int first, last, fields;
+	char *item=list;
+
+	while (item!=NULL) {
+		fields=sscanf(item,"%d-%d",&first,&last);
+		if (fields<1)
+			return -1;
+		if (fields==1)
+			last=first;
+		if (first<0 || last<first || last>=size)
+			return -1;
+		for (; first<=last; first++)
+			marks[first]=1;
+		item=strchr(item,',');
+		if (item!=NULL)
+			item++;
+	}
+	return 0;
 }
 
 // Fill ArrivalTimeQueue heap with user program from parameters and daemons 
@@ -222,14 +311,29 @@ void ComputerSystem_FillInArrivalTimeQueue() {
 	  Heap_add(arrivalIndex,arrivalTimeQueue,QUEUE_ARRIVAL,&arrivalIndex,PROGRAMSMAXNUMBER);
 	}
 	numberOfProgramsInArrivalTimeQueue=arrivalIndex;
+	statusDirty|=STATUS_ARRIVAL;
+
+	// Programs not arriving at the beginning are simulation events
+	for (arrivalIndex=0; arrivalIndex<numberOfProgramsInArrivalTimeQueue; arrivalIndex++)
+		if (programList[arrivalIndex]->arrivalTime>0)
+			Events_Schedule(programList[arrivalIndex]->arrivalTime, EVENT_ARRIVAL, arrivalIndex);
 #endif
 }
 
+// A program arrival. With periodic interrupts the LTS finds it on the next clock
+// interrupt; with the one-shot timer the arrival has to raise the interrupt itself
+void ComputerSystem_ArrivalEvent(int indexInProgramList) {
+	if (Clock_GetMode()==CLOCK_ONESHOT)
+		Processor_RaiseInterrupt(CLOCKINT_BIT);
+}
+
 // Print arrivalTiemQueue program information
 void ComputerSystem_PrintArrivalTimeQueue(){
 #ifdef ARRIVALQUEUE
   int i;
   
+  if (!ComputerSystem_IsDebugEnabled(LONGTERMSCHEDULE))
+	return;
   if (numberOfProgramsInArrivalTimeQueue>0) {
 	OperatingSystem_ShowTime(LONGTERMSCHEDULE);
 	// Show message "Arrival Time Queue: "
@@ -4,18 +4,34 @@
 #include "ComputerSystem.h"
 #include "Heap.h"
 
+// Bit of a section (a lowercase letter) into debugSectionsMask
+#define ComputerSystem_SectionBit(section) (1u << ((section) - 'a'))
+
+// Cheap check for callers, to avoid building the arguments of messages not shown.
+// Compiling with NO_HARDWARE_TRACE removes the HARDWARE section tracing entirely
+#ifdef NO_HARDWARE_TRACE
+#define ComputerSystem_IsDebugEnabled(section) ((section) != HARDWARE && (debugSectionsMask & ComputerSystem_SectionBit(section)))
+#else
+#define ComputerSystem_IsDebugEnabled(section) (debugSectionsMask & ComputerSystem_SectionBit(section))
+#endif
+
 // Functions prototypes
 int ComputerSystem_ObtainProgramList(int , char *[], int);
 void ComputerSystem_DebugMessage(int, char , ...);
+void ComputerSystem_ProcessDebugMessage(int, int, char , ...);
+void ComputerSystem_TimeStamp(char, int);
 void ComputerSystem_ShowTime(char);
 void ComputerSystem_FillInArrivalTimeQueue();
 void ComputerSystem_PrintArrivalTimeQueue();
+void ComputerSystem_ArrivalEvent(int);
 
 // This "extern" declarations enables other source code files to gain access to the variables 
 extern char defaultDebugLevel[];
+extern unsigned int debugSectionsMask;
+extern char *traceFilterExpression;
 extern int intervalBetweenInterrupts;
 
-extern int endSimulationTime; // For end simulation forced by time
+extern SIMTIME endSimulationTime; // For end simulation forced by time
 
 #ifdef ARRIVALQUEUE
 extern int numberOfProgramsInArrivalTimeQueue;
@@ -0,0 +1,98 @@
+#include "Events.h"
+#include "Heap.h"
+#include "Clock.h"
+#include "Asserts.h"
+#include "ComputerSystemBase.h"
+
+// Pending events, and heap of their identifiers sorted by time
+EVENT events[EVENTSMAXNUMBER];
+heapItem eventsQueue[EVENTSMAXNUMBER];
+int numberOfEventsInQueue=0;
+
+// Time of the first event into eventsQueue, checked by the clock on every tick
+SIMTIME nextEventTime=EVENTS_NEVER;
+
+// Internal Functions prototypes
+void Events_UpdateNextEventTime();
+
+// Insertion of an event into the events queue
+// return event identifier/-1  ok/fail
+int Events_Schedule(SIMTIME time, int type, int info) {
+	int id;
+
+	for (id=0; id<EVENTSMAXNUMBER && events[id].type!=EVENT_FREE; id++);
+	if (id==EVENTSMAXNUMBER)
+		return -1;
+	events[id].time=time;
+	events[id].type=type;
+	events[id].info=info;
+	Heap_add(id, eventsQueue, QUEUE_EVENTS, &numberOfEventsInQueue, EVENTSMAXNUMBER);
+	Events_UpdateNextEventTime();
+	return id;
+}
+
+// Removal of a pending event. The queue is rebuilt without it, keeping the
+// order of the other events (it only holds a few of them)
+void Events_Cancel(int id) {
+	heapItem pending[EVENTSMAXNUMBER];
+	int numberOfPendingEvents=0;
+	int i;
+
+	if (id<0 || id>=EVENTSMAXNUMBER || events[id].type==EVENT_FREE)
+		return;
+	events[id].type=EVENT_FREE;
+	while (numberOfEventsInQueue>0) {
+		i=Heap_poll(eventsQueue, QUEUE_EVENTS, &numberOfEventsInQueue);
+		if (i!=id)
+			pending[numberOfPendingEvents++].info=i;
+	}
+	for (i=0; i<numberOfPendingEvents; i++)
+		Heap_add(pending[i].info, eventsQueue, QUEUE_EVENTS, &numberOfEventsInQueue, EVENTSMAXNUMBER);
+	Events_UpdateNextEventTime();
+}
+
+// Events with the same time keep their order
+void Events_Reschedule(int id, SIMTIME time) {
+	if (id<0 || id>=EVENTSMAXNUMBER || events[id].type==EVENT_FREE)
+		return;
+	events[id].time=time;
+	Heap_Rebuild(eventsQueue, QUEUE_EVENTS, numberOfEventsInQueue);
+	Events_UpdateNextEventTime();
+}
+
+SIMTIME Events_NextEventTime() {
+	return nextEventTime;
+}
+
+// Handling of the events whose time has come
+void Events_Dispatch(SIMTIME now) {
+	int id;
+	EVENT event;
+
+	while (numberOfEventsInQueue>0 && events[Heap_getFirst(eventsQueue, numberOfEventsInQueue)].time<=now) {
+		id=Heap_poll(eventsQueue, QUEUE_EVENTS, &numberOfEventsInQueue);
+		event=events[id];
+		events[id].type=EVENT_FREE; // Handlers may reuse it
+		switch (event.type) {
+			case EVENT_TIMER:
+				Clock_TimerEvent();
+				break;
+			case EVENT_ARRIVAL:
+				ComputerSystem_ArrivalEvent(event.info);
+				break;
+			case EVENT_ASSERT:
+				Asserts_CheckpointEvent();
+				break;
+			case EVENT_DEVICE: // No device is simulated yet
+				break;
+		}
+	}
+	Events_UpdateNextEventTime();
+}
+
+void Events_UpdateNextEventTime() {
+	if (numberOfEventsInQueue>0)
+		nextEventTime=events[Heap_getFirst(eventsQueue, numberOfEventsInQueue)].time;
+	else
+		nextEventTime=EVENTS_NEVER;
+}
@@ -0,0 +1,41 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "Simulator.h"
+
+// Maximum number of pending events: one per program arrival plus clock, devices and asserts
+#define EVENTSMAXNUMBER (PROGRAMSMAXNUMBER + 16)
+
+// Time returned when no event is pending
+#define EVENTS_NEVER 0x7fffffffffffffffLL
+
+// Types of simulation events
+enum EventTypes { EVENT_FREE, EVENT_TIMER, EVENT_DEVICE, EVENT_ARRIVAL, EVENT_ASSERT };
+
+// A simulation event happens at a given time. "info" depends on its type
+typedef struct {
+	SIMTIME time;
+	int type;
+	int info;
+} EVENT;
+
+// Adds an event to the queue of pending events.
+// Returns its identifier (for cancelling it) or -1 if there is no room for it
+int Events_Schedule(SIMTIME, int, int);
+
+// Cancels a pending event given its identifier
+void Events_Cancel(int);
+
+// Changes the time of a pending event given its identifier
+void Events_Reschedule(int, SIMTIME);
+
+// Returns the time of the earliest pending event or EVENTS_NEVER. Between
+// two events nothing but the executed instructions can raise an interrupt
+SIMTIME Events_NextEventTime();
+
+// Handles, in time order, every pending event whose time is not after the given one
+void Events_Dispatch(SIMTIME);
+
+extern EVENT events[];
+
+#endif
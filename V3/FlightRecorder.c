@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "FlightRecorder.h"
+#include "Clock.h"
+#include "Log.h"
+#include "OperatingSystem.h"
+
+char defaultFlightRecorderFile[]="flightrecorder.log";
+char *flightRecorderFile=defaultFlightRecorderFile;
+
+// The ring: only the last FLIGHTRECORDERSIZE events are kept
+FLIGHT_EVENT flightEvents[FLIGHTRECORDERSIZE];
+unsigned long long numberOfFlightEvents=0;
+
+// Descriptor of the dumps file, opened at the beginning so a crash only has to write.
+// The first dump empties it, the next ones are appended
+int flightRecorderFD=-1;
+int flightRecorderCreated=0;
+int flightRecorderDumped=0;
+
+extern char *statesNames[];
+
+// Internal Functions prototypes
+void FlightRecorder_SignalHandler(int);
+void FlightRecorder_Terminate();
+void FlightRecorder_WriteEvents(const char *, SIMTIME);
+void FlightRecorder_WriteEvent(FLIGHT_EVENT *);
+void FlightRecorder_Write(const char *, int);
+int FlightRecorder_PutString(char *, int, const char *);
+int FlightRecorder_PutNumber(char *, int, long long);
+int FlightRecorder_PutHex(char *, int, unsigned int, int);
+
+// A crash also dumps the last events
+void FlightRecorder_Initialize() {
+	if (flightRecorderFile[0]!=0 && flightRecorderFD<0) {
+		// A file left by a previous run keeps its contents until the first dump
+		flightRecorderFD=open(flightRecorderFile, O_WRONLY);
+		if (flightRecorderFD<0) {
+			flightRecorderFD=open(flightRecorderFile, O_WRONLY | O_CREAT | O_EXCL, 0644);
+			flightRecorderCreated=flightRecorderFD>=0;
+		}
+		atexit(FlightRecorder_Terminate);
+	}
+	signal(SIGSEGV, FlightRecorder_SignalHandler);
+	signal(SIGABRT, FlightRecorder_SignalHandler);
+}
+
+// A file created for dumps that never happened is removed
+void FlightRecorder_Terminate() {
+	if (flightRecorderFD<0)
+		return;
+	close(flightRecorderFD);
+	flightRecorderFD=-1;
+	if (flightRecorderCreated && !flightRecorderDumped)
+		unlink(flightRecorderFile);
+}
+
+void FlightRecorder_Record(int type, int value0, int value1, int value2) {
+	FLIGHT_EVENT *event=&flightEvents[numberOfFlightEvents++ & (FLIGHTRECORDERSIZE-1)];
+
+	event->tick=Clock_GetTime();
+	event->type=type;
+	event->values[0]=value0;
+	event->values[1]=value1;
+	event->values[2]=value2;
+}
+
+// Writes the recorded events, oldest first. The output written so far reaches
+// its sink too, so both can be compared
+void FlightRecorder_Dump(const char *reason) {
+	Log_Flush();
+	if (flightRecorderFD<0 && flightRecorderFile[0]!=0)
+		flightRecorderFD=open(flightRecorderFile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	FlightRecorder_WriteEvents(reason, Clock_GetTime());
+}
+
+// Only write() and the formatting below, so it can also be used from a signal handler
+void FlightRecorder_WriteEvents(const char *reason, SIMTIME tick) {
+	char text[160];
+	unsigned long long i, first, last=numberOfFlightEvents;
+	int length;
+
+	if (flightRecorderFD<0)
+		return;
+	if (!flightRecorderDumped) {
+		flightRecorderDumped=1;
+		if (ftruncate(flightRecorderFD, 0)!=0)
+			return;
+	}
+	first=last>FLIGHTRECORDERSIZE ? last-FLIGHTRECORDERSIZE : 0;
+	length=FlightRecorder_PutString(text, 0, "--- ");
+	length=FlightRecorder_PutString(text, length, reason);
+	length=FlightRecorder_PutString(text, length, " at tick ");
+	length=FlightRecorder_PutNumber(text, length, tick);
+	length=FlightRecorder_PutString(text, length, ", last ");
+	length=FlightRecorder_PutNumber(text, length, last-first);
+	length=FlightRecorder_PutString(text, length, " events ---\n");
+	FlightRecorder_Write(text, length);
+	for (i=first; i<last; i++)
+		FlightRecorder_WriteEvent(&flightEvents[i & (FLIGHTRECORDERSIZE-1)]);
+}
+
+void FlightRecorder_WriteEvent(FLIGHT_EVENT *event) {
+	char text[160];
+	int length;
+
+	length=FlightRecorder_PutString(text, 0, "[");
+	length=FlightRecorder_PutNumber(text, length, event->tick);
+	length=FlightRecorder_PutString(text, length, "] ");
+	switch (event->type) {
+		case FLIGHT_FETCH:
+			length=FlightRecorder_PutString(text, length, "FETCH PC: ");
+			length=FlightRecorder_PutNumber(text, length, event->values[0]);
+			length=FlightRecorder_PutString(text, length, " IR: {");
+			length=FlightRecorder_PutHex(text, length, (event->values[1]>>24)&0xff, 2);
+			length=FlightRecorder_PutString(text, length, " ");
+			length=FlightRecorder_PutHex(text, length, (event->values[1]>>12)&0xfff, 3);
+			length=FlightRecorder_PutString(text, length, " ");
+			length=FlightRecorder_PutHex(text, length, event->values[1]&0xfff, 3);
+			length=FlightRecorder_PutString(text, length, "}");
+			break;
+		case FLIGHT_RAISE:
+			length=FlightRecorder_PutString(text, length, "INTERRUPT ");
+			length=FlightRecorder_PutNumber(text, length, event->values[0]);
+			length=FlightRecorder_PutString(text, length, " raised");
+			break;
+		case FLIGHT_ACK:
+			length=FlightRecorder_PutString(text, length, "INTERRUPT ");
+			length=FlightRecorder_PutNumber(text, length, event->values[0]);
+			length=FlightRecorder_PutString(text, length, " acknowledged");
+			break;
+		case FLIGHT_DISPATCH:
+			length=FlightRecorder_PutString(text, length, "DISPATCH PID: ");
+			length=FlightRecorder_PutNumber(text, length, event->values[0]);
+			break;
+		case FLIGHT_STATE:
+			length=FlightRecorder_PutString(text, length, "STATE PID: ");
+			length=FlightRecorder_PutNumber(text, length, event->values[0]);
+			length=FlightRecorder_PutString(text, length, " ");
+			// An event being recorded when the crash came may be half written
+			if (event->values[1]>=NEW && event->values[1]<=EXIT && event->values[2]>=NEW && event->values[2]<=EXIT) {
+				length=FlightRecorder_PutString(text, length, statesNames[event->values[1]]);
+				length=FlightRecorder_PutString(text, length, " -> ");
+				length=FlightRecorder_PutString(text, length, statesNames[event->values[2]]);
+			}
+			break;
+	}
+	length=FlightRecorder_PutString(text, length, "\n");
+	FlightRecorder_Write(text, length);
+}
+
+// Plain writes, also used after a crash
+void FlightRecorder_Write(const char *text, int length) {
+	if (write(flightRecorderFD, text, length)<0)
+		return;
+}
+
+// Formatting into a text of 160 bytes, the last one kept for a newline. Each returns the new length
+int FlightRecorder_PutString(char *text, int length, const char *string) {
+	while (*string!=0 && length<158)
+		text[length++]=*string++;
+	return length;
+}
+
+int FlightRecorder_PutNumber(char *text, int length, long long number) {
+	char digits[24];
+	int numberOfDigits=0;
+	unsigned long long value=number<0 ? -(unsigned long long) number : (unsigned long long) number;
+
+	do {
+		digits[numberOfDigits++]='0'+value%10;
+		value/=10;
+	} while (value>0);
+	if (number<0)
+		digits[numberOfDigits++]='-';
+	while (numberOfDigits>0 && length<158)
+		text[length++]=digits[--numberOfDigits];
+	return length;
+}
+
+int FlightRecorder_PutHex(char *text, int length, unsigned int number, int width) {
+	while (width-->0 && length<158)
+		text[length++]="0123456789ABCDEF"[(number>>(4*width))&0xf];
+	return length;
+}
+
+// No flush of the output nor any other call that may be interrupted by the crash: the
+// writer thread or stdio may be the ones that crashed, or be halfway through
+void FlightRecorder_SignalHandler(int signalNumber) {
+	unsigned long long last=numberOfFlightEvents;
+
+	// The clock as the last event saw it
+	FlightRecorder_WriteEvents(signalNumber==SIGSEGV ? "SIGSEGV" : "SIGABRT",
+		last>0 ? flightEvents[(last-1) & (FLIGHTRECORDERSIZE-1)].tick : 0);
+	// The default action ends the simulation
+	signal(signalNumber, SIG_DFL);
+	raise(signalNumber);
+}
@@ -0,0 +1,28 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include "Simulator.h"
+
+// Always-on record of the last machine events, written into flightRecorderFile when
+// something goes wrong: exceptions, fatal errors, failed asserts and crashes
+
+// Number of events kept (a power of two)
+#define FLIGHTRECORDERSIZE 1024
+
+enum FlightRecorderEvents { FLIGHT_FETCH, FLIGHT_RAISE, FLIGHT_ACK, FLIGHT_DISPATCH, FLIGHT_STATE };
+
+typedef struct {
+	SIMTIME tick;
+	int type;
+	int values[3];	// PC and IR / interrupt / PID / PID, old state and new state
+} FLIGHT_EVENT;
+
+// Functions prototypes
+void FlightRecorder_Initialize();
+void FlightRecorder_Record(int, int, int, int);
+void FlightRecorder_Dump(const char *);
+
+// File for the dumps (none if empty)
+extern char *flightRecorderFile;
+
+#endif
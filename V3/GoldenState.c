@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GoldenState.h"
+#include "Asserts.h"
+#include "AssertsFile.h"
+#include "Clock.h"
+#include "ComputerSystem.h"
+#include "FlightRecorder.h"
+#include "Varint.h"
+
+void GoldenState_ReadState(int *);
+void GoldenState_Capture(SIMTIME);
+void GoldenState_Verify(SIMTIME);
+int GoldenState_ApplyFrame();
+int GoldenState_CompareSlots(const void *, const void *);
+
+char *goldenCaptureFile="";
+char *goldenVerifyFile="";
+
+GOLDEN_SLOT goldenSlots[GOLDENSTATEMAXSLOTS];
+int numberOfGoldenSlots=0;
+
+// Slots read after every instruction, and first slot of the elements of a memory cell,
+// read only when the cell is written
+int goldenValueSlots[GOLDENSTATEMAXSLOTS];
+int numberOfGoldenValueSlots=0;
+int goldenCellBases[NUMBEROFASSERTELEMENTS];
+int numberOfGoldenCellElements=0;
+
+// Cells written since the last instruction. Every slot is read after a restored state
+int goldenWrittenCells[MAINMEMORYSIZE];
+char goldenCellWritten[MAINMEMORYSIZE];
+int numberOfGoldenWrittenCells=0;
+int goldenReadAll=1;
+
+// Slots read by the last call to GoldenState_ReadState, and the ones of them that changed
+int goldenReadSlots[GOLDENSTATEMAXSLOTS];
+int numberOfGoldenReadSlots=0;
+int goldenChangedSlots[GOLDENSTATEMAXSLOTS];
+
+FILE *goldenFile=NULL;
+int goldenCapturing=0;
+
+// Capture: state written last. Verify: state of the golden run at goldenTick
+int goldenPrevious[GOLDENSTATEMAXSLOTS];
+int goldenCurrent[GOLDENSTATEMAXSLOTS];
+char goldenDiffers[GOLDENSTATEMAXSLOTS];
+SIMTIME goldenTick=0;
+
+// Verify: tick of the next frame, -1 at the end of the file
+SIMTIME goldenNextFrame=-1;
+int goldenDifferences=0;
+int goldenFramesNotReached=0;
+
+// The slots are built from the golden elements, one per memory cell or PCB when they have an address
+void GoldenState_Initialize() {
+	int element, address, addresses;
+	char magic[GOLDENSTATE_MAGICLENGTH];
+	unsigned long long value, slots;
+	int slot;
+
+	if (goldenCaptureFile[0]==0 && goldenVerifyFile[0]==0)
+		return;
+	for (element=0; element<NUMBEROFASSERTELEMENTS; element++) {
+		if (!elementGolden[element])
+			continue;
+		switch (elementAddress[element]) {
+			case ASSERT_MEMORYADDRESS: addresses=MAINMEMORYSIZE; break;
+			case ASSERT_PCBADDRESS: addresses=PROCESSTABLEMAXSIZE; break;
+			default: addresses=1;
+		}
+		if (elementWatch[element]==ASSERT_WATCHCELL)
+			goldenCellBases[numberOfGoldenCellElements++]=numberOfGoldenSlots;
+		for (address=0; address<addresses; address++) {
+			if (elementWatch[element]!=ASSERT_WATCHCELL)
+				goldenValueSlots[numberOfGoldenValueSlots++]=numberOfGoldenSlots;
+			goldenSlots[numberOfGoldenSlots].element=element;
+			goldenSlots[numberOfGoldenSlots++].address=address;
+		}
+	}
+
+	if (goldenCaptureFile[0]!=0) {
+		goldenCapturing=1;
+		goldenFile=fopen(goldenCaptureFile, "wb");
+		if (goldenFile==NULL) {
+			ComputerSystem_DebugMessage(97,POWERON,goldenCaptureFile);
+			return;
+		}
+		fwrite(GOLDENSTATE_MAGIC, 1, GOLDENSTATE_MAGICLENGTH, goldenFile);
+		Varint_Write(goldenFile, numberOfGoldenSlots);
+		for (slot=0; slot<numberOfGoldenSlots; slot++) {
+			Varint_Write(goldenFile, goldenSlots[slot].element);
+			Varint_Write(goldenFile, goldenSlots[slot].address);
+		}
+		return;
+	}
+
+	// The slots of the file must be the same ones
+	goldenFile=fopen(goldenVerifyFile, "rb");
+	if (goldenFile==NULL
+	 || fread(magic, 1, GOLDENSTATE_MAGICLENGTH, goldenFile)!=GOLDENSTATE_MAGICLENGTH
+	 || memcmp(magic, GOLDENSTATE_MAGIC, GOLDENSTATE_MAGICLENGTH)
+	 || Varint_Read(goldenFile, &slots)<0 || slots!=numberOfGoldenSlots) {
+		ComputerSystem_DebugMessage(97,POWERON,goldenVerifyFile);
+		if (goldenFile!=NULL)
+			fclose(goldenFile);
+		goldenFile=NULL;
+		return;
+	}
+	for (slot=0; slot<numberOfGoldenSlots; slot++)
+		if (Varint_Read(goldenFile, &value)<0 || value!=goldenSlots[slot].element
+		 || Varint_Read(goldenFile, &value)<0 || value!=goldenSlots[slot].address) {
+			ComputerSystem_DebugMessage(97,POWERON,goldenVerifyFile);
+			fclose(goldenFile);
+			goldenFile=NULL;
+			return;
+		}
+	if (Varint_Read(goldenFile, &value)==0)
+		goldenNextFrame=value;
+}
+
+// Only the slots that may have changed since the last call are read into state
+void GoldenState_ReadState(int *state) {
+	int slot, cell, element;
+
+	numberOfGoldenReadSlots=0;
+	if (goldenReadAll) {
+		for (slot=0; slot<numberOfGoldenSlots; slot++)
+			goldenReadSlots[numberOfGoldenReadSlots++]=slot;
+		goldenReadAll=0;
+	}
+	else {
+		for (slot=0; slot<numberOfGoldenValueSlots; slot++)
+			goldenReadSlots[numberOfGoldenReadSlots++]=goldenValueSlots[slot];
+		for (cell=0; cell<numberOfGoldenWrittenCells; cell++)
+			for (element=0; element<numberOfGoldenCellElements; element++)
+				goldenReadSlots[numberOfGoldenReadSlots++]=goldenCellBases[element]+goldenWrittenCells[cell];
+	}
+	for (slot=0; slot<numberOfGoldenReadSlots; slot++)
+		state[goldenReadSlots[slot]]=Asserts_ReadElement(goldenSlots[goldenReadSlots[slot]].element,
+			goldenSlots[goldenReadSlots[slot]].address);
+	for (cell=0; cell<numberOfGoldenWrittenCells; cell++)
+		goldenCellWritten[goldenWrittenCells[cell]]=0;
+	numberOfGoldenWrittenCells=0;
+}
+
+// Called by MainMemory_SetCTRL when a cell is written
+void GoldenState_MemoryWritten(int address) {
+	if (goldenFile==NULL || goldenReadAll || goldenCellWritten[address])
+		return;
+	goldenCellWritten[address]=1;
+	goldenWrittenCells[numberOfGoldenWrittenCells++]=address;
+}
+
+// The memory was written as a whole (a restored checkpoint or simulation)
+void GoldenState_StateRestored() {
+	goldenReadAll=1;
+}
+
+// Called after every instruction
+void GoldenState_Check() {
+	if (goldenFile==NULL)
+		return;
+	GoldenState_ReadState(goldenCurrent);
+	if (goldenCapturing)
+		GoldenState_Capture(Clock_GetTime());
+	else
+		GoldenState_Verify(Clock_GetTime());
+}
+
+// A frame with the slots changed since the last one. Only the slots just read can have
+// changed; the frame has them in order
+void GoldenState_Capture(SIMTIME tick) {
+	int slot, previousSlot=0, changes=0, change;
+
+	for (slot=0; slot<numberOfGoldenReadSlots; slot++)
+		if (goldenCurrent[goldenReadSlots[slot]]!=goldenPrevious[goldenReadSlots[slot]])
+			goldenChangedSlots[changes++]=goldenReadSlots[slot];
+	if (changes==0)
+		return;
+	qsort(goldenChangedSlots, changes, sizeof(int), GoldenState_CompareSlots);
+	Varint_Write(goldenFile, tick-goldenTick);
+	Varint_Write(goldenFile, changes);
+	for (change=0; change<changes; change++) {
+		slot=goldenChangedSlots[change];
+		Varint_Write(goldenFile, slot-previousSlot);
+		Varint_Write(goldenFile, Varint_ZigZag(goldenCurrent[slot]));
+		goldenPrevious[slot]=goldenCurrent[slot];
+		previousSlot=slot;
+	}
+	goldenTick=tick;
+}
+
+int GoldenState_CompareSlots(const void *slot1, const void *slot2) {
+	return *(const int *) slot1-*(const int *) slot2;
+}
+
+// The frames up to now are applied to the golden state, which must be the current one.
+// A difference is shown when it appears, not again while it lasts
+void GoldenState_Verify(SIMTIME tick) {
+	int slot;
+
+	while (goldenNextFrame>=0 && goldenTick+goldenNextFrame<=tick)
+		if (!GoldenState_ApplyFrame()) {
+			ComputerSystem_DebugMessage(97,ERROR,goldenVerifyFile);
+			fclose(goldenFile);
+			goldenFile=NULL;
+			return;
+		}
+	for (slot=0; slot<numberOfGoldenSlots; slot++)
+		if (goldenCurrent[slot]!=goldenPrevious[slot]) {
+			if (!goldenDiffers[slot]) {
+				goldenDiffers[slot]=1;
+				goldenDifferences++;
+				ComputerSystem_DebugMessage(96,ERROR,tick,elements[goldenSlots[slot].element],goldenSlots[slot].address,goldenPrevious[slot],goldenCurrent[slot]);
+				if (goldenDifferences==1)
+					FlightRecorder_Dump("Golden state differs");
+			}
+		}
+		else
+			goldenDiffers[slot]=0;
+}
+
+int GoldenState_ApplyFrame() {
+	unsigned long long changes, slotIncrement, value;
+	int slot=0;
+
+	goldenTick+=goldenNextFrame;
+	if (Varint_Read(goldenFile, &changes)<0)
+		return 0;
+	while (changes-->0) {
+		if (Varint_Read(goldenFile, &slotIncrement)<0 || Varint_Read(goldenFile, &value)<0)
+			return 0;
+		slot+=slotIncrement;
+		if (slot>=numberOfGoldenSlots)
+			return 0;
+		goldenPrevious[slot]=Varint_UnZigZag(value);
+	}
+	if (Varint_Read(goldenFile, &slotIncrement)==0)
+		goldenNextFrame=slotIncrement;
+	else
+		goldenNextFrame=-1;
+	return 1;
+}
+
+void GoldenState_Terminate() {
+	if (goldenFile==NULL)
+		return;
+	if (!goldenCapturing) {
+		// Changes of the golden run after the end of this one
+		while (goldenNextFrame>=0 && GoldenState_ApplyFrame())
+			goldenFramesNotReached++;
+		ComputerSystem_DebugMessage(98,SHUTDOWN,goldenVerifyFile,goldenDifferences,goldenFramesNotReached);
+	}
+	fclose(goldenFile);
+	goldenFile=NULL;
+}
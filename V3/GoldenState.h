@@ -0,0 +1,42 @@
+#ifndef GOLDENSTATE_H
+#define GOLDENSTATE_H
+
+#include <stdio.h>
+#include "Simulator.h"
+#include "Asserts.h"
+
+// Golden state: the architectural state (the golden elements of AssertElements.def: CPU,
+// MMU and main memory registers, memory cells and PCB fields) is captured after every
+// instruction into goldenCaptureFile, only what has changed. A later run verifies
+// its own state against the file given in goldenVerifyFile
+//   GOLDENSTATE_MAGIC, number of slots, element and address of every slot, and frames:
+//   tick increment, number of changes, and for every change slot increment and value
+// Numbers are varints, values zigzag encoded
+#define GOLDENSTATE_MAGIC "SIMGOLD\001"
+#define GOLDENSTATE_MAGICLENGTH 8
+
+// Slots of the state: one per golden element, per memory cell or PCB when it has an address
+enum { GOLDENSTATEMAXSLOTS=0
+#define ASSERT_ELEMENT(name,valueIsInstruction,shownAsInstruction,address,watch,golden) \
+	+(golden)*((address)==ASSERT_MEMORYADDRESS ? MAINMEMORYSIZE : (address)==ASSERT_PCBADDRESS ? PROCESSTABLEMAXSIZE : 1)
+#include "AssertElements.def"
+#undef ASSERT_ELEMENT
+};
+
+typedef struct {
+	int element;
+	int address;
+} GOLDEN_SLOT;
+
+// Functions prototypes
+void GoldenState_Initialize();
+void GoldenState_Check();
+void GoldenState_MemoryWritten(int);
+void GoldenState_StateRestored();
+void GoldenState_Terminate();
+
+// Capture and verify files (none if empty)
+extern char *goldenCaptureFile;
+extern char *goldenVerifyFile;
+
+#endif
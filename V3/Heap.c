@@ -2,13 +2,15 @@
 #include "Heap.h"
 #include "OperatingSystem.h"
 #include "Asserts.h"
+#include "Events.h"
 
 // Internal Functions prototypes
 void Heap_swap_Up(int, heapItem[], int);
 void Heap_swap_Down(int, heapItem[], int, int);
 int Heap_InsertionTime(unsigned int , unsigned int );
+int Heap_compare_time(SIMTIME, SIMTIME);
 
-int counter=1;
+unsigned int counter=1;
 
 // Insertion of a PID into a binary heap
 // info: PID or other info to insert
@@ -55,6 +57,14 @@ int Heap_getFirst(heapItem heap[], int numElem) {
 		return -1;
 }
 
+// Every item goes up from its position, over a prefix already in order
+void Heap_Rebuild(heapItem heap[], int queueType, int numElem) {
+	int p;
+
+	for (p=1; p<numElem; p++)
+		Heap_swap_Up(p, heap, queueType);
+}
+
 //  Auxiliary function for implementation of binary heaps
 void Heap_swap_Up(int p, heapItem heap[], int queueType) {
 	if (p > 0)  { // if not at the top...
@@ -103,7 +113,7 @@ int Heap_compare_priority(int value1, int value2) {
 // Auxiliary for  WakeUp-time comparations
 int Heap_compare_wakeup(int value1, int value2) {
 #ifdef SLEEPINGQUEUE
-	return processTable[value2].whenToWakeUp - processTable[value1].whenToWakeUp;
+	return Heap_compare_time(processTable[value1].whenToWakeUp, processTable[value2].whenToWakeUp);
 #else
 	return 0;
 #endif
@@ -111,12 +121,17 @@ int Heap_compare_wakeup(int value1, int value2) {
 
 // Auxiliary for arrival-time comparations
 int Heap_compare_arrival(int value1, int value2) {
-  return programList[value2]->arrivalTime - programList[value1]->arrivalTime;
+  return Heap_compare_time(programList[value1]->arrivalTime, programList[value2]->arrivalTime);
 }
 
 // Auxiliary for assert-time comparations
 int Heap_compare_assertsTime(int value1, int value2) {
-  return asserts[value2].time - asserts[value1].time;
+  return Heap_compare_time(asserts[value1].time, asserts[value2].time);
+}
+
+// Auxiliary for event-time comparations
+int Heap_compare_eventsTime(int value1, int value2) {
+  return Heap_compare_time(events[value1].time, events[value2].time);
 }
 
 // Auxiliary for generic comparations
@@ -135,6 +150,9 @@ int Heap_compare(heapItem value1, heapItem value2, int queueType) {
 	case QUEUE_ASSERTS:
 		primaryKey= Heap_compare_assertsTime(value1.info, value2.info);
 		break;
+	case QUEUE_EVENTS:
+		primaryKey= Heap_compare_eventsTime(value1.info, value2.info);
+		break;
   }
   
   if (primaryKey==0)
@@ -143,8 +161,15 @@ int Heap_compare(heapItem value1, heapItem value2, int queueType) {
 
 }
 
-// Auxiliary for secondaryKey comparations
+// Auxiliary for time comparations. No subtraction, so the difference of two
+// 64 bits times never overflows the int result
+int Heap_compare_time(SIMTIME time1, SIMTIME time2) {
+	return (time1 < time2) - (time1 > time2);
+}
+
+// Auxiliary for secondaryKey comparations. The insertion counter wraps around, so
+// the older item is the one whose distance to the other one is positive modulo 2^32
 int Heap_InsertionTime(unsigned int value1, unsigned int value2){
-	return value2 - value1;
+	return (int) (value2 - value1) > 0 ? 1 : ((int) (value2 - value1) < 0 ? -1 : 0);
 }
 
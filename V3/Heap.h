@@ -5,6 +5,7 @@
 #define QUEUE_PRIORITY 1
 #define QUEUE_ARRIVAL 2
 #define QUEUE_ASSERTS 3
+#define QUEUE_EVENTS 4
 
 typedef struct  {
 	int info;
@@ -15,7 +16,7 @@ typedef struct  {
 // Implements the extraction operation (the element with the highest priority).
 // Parameters are:
 //    heap: the corresponding queue: readyToRun, asserts, UserProgramList or sleepingQueue
-//    queueType: if sleeping queue, QUEUE_WAKEUP; if ready to run queue, QUEUE_PRIORITY; if asserts QUEUE_ASSERTS; if userProgramList, QUEUE_ARRIVAL
+//    queueType: if sleeping queue, QUEUE_WAKEUP; if ready to run queue, QUEUE_PRIORITY; if asserts QUEUE_ASSERTS; if userProgramList, QUEUE_ARRIVAL; if simulation events, QUEUE_EVENTS
 //    numElem: number of current elements inside the queue, if successful is decremented by one
 // Returns: the item with the highest priority in the queue, if everything went ok
 int Heap_poll(heapItem[], int, int*);
@@ -43,4 +44,10 @@ int Heap_compare(heapItem, heapItem, int);
 // return more priority item, but not extract from heap
 int Heap_getFirst(heapItem[], int);
 
+// Restores the order of a heap whose items have changed their keys
+// heap: Binary heap to reorder
+// queueType: as in Heap_add
+// numElem: number of elements actually into the queue
+void Heap_Rebuild(heapItem[], int, int);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include <strings.h>
+#include "ProcessorBase.h"
+
+// Names of the instructions, shared by the simulator and the simasserts tool
+char *InstructionNames[] = {
+"NONEXISTING_INSTRUCTION",
+#define INST(name) #name, // #name cast parameter name to String
+#include "Instructions.def"
+#undef INST
+};
+
+int Processor_ToInstruction(char * operation) {
+	int i;
+	for (i=0;i<LAST_INST;i++)
+		if (strcasecmp(InstructionNames[i],operation)==0)
+			return i;
+	return NONEXISTING_INST;
+}
@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include "Library.h"
+#include "Checkpoint.h"
+#include "ComputerSystemBase.h"
+#include "OperatingSystem.h"
+#include "Processor.h"
+#include "ProcessorBase.h"
+#include "Clock.h"
+#include "Messages.h"
+#include "Log.h"
+#include "FlightRecorder.h"
+#include "CheckpointCache.h"
+
+// Internal Functions prototypes
+void Library_Bring(SIM *);
+void Library_Boot(SIM *);
+void Library_Cycle(SIM *);
+void Library_Failed(SIM *);
+void Library_FreePrograms(PROGRAMS_DATA **);
+void Library_SaveGlobals(SIM *);
+void Library_RestoreGlobals(SIM *);
+
+extern int initialPID;
+extern SIMTIME endSimulationTime;
+extern SIMTIME nextCheckpointTick;
+extern SIMTIME verifyTime;
+extern SIMTIME nextCacheArrival;
+extern int interruptLines_CPU;
+
+pthread_mutex_t libraryMutex=PTHREAD_MUTEX_INITIALIZER;
+
+// Simulation in the globals (none if NULL)
+SIM *currentSim=NULL;
+
+// The globals before any simulation: the start of every new one
+char *initialState=NULL;
+SIM libraryDefaults;
+
+// The output is started by the first simulation that runs
+int libraryOutputStarted=0;
+
+// Where a fatal error of the simulation being run goes back to
+jmp_buf libraryFatalError;
+
+// A new simulation with the options given as in the command line
+SIM *sim_create(const char *configuration) {
+	SIM *sim=(SIM *) calloc(1, sizeof(SIM));
+	char *option, *value;
+
+	if (sim==NULL)
+		return NULL;
+	sim->state=SIM_NEW;
+	sim->configuration=strdup(configuration==NULL ? "" : configuration);
+	for (option=strtok(sim->configuration, " \t"); option!=NULL; option=strtok(NULL, " \t")) {
+		if (strncmp(option, "--", 2)!=0 || sim->numberOfOptions==LIBRARY_MAXOPTIONS) {
+			sim_destroy(sim);
+			return NULL;
+		}
+		option+=2;
+		value=strchr(option, '=');
+		if (value!=NULL)
+			*value++=0;
+		if (Simulator_GetOption(option)<=0) {
+			sim_destroy(sim);
+			return NULL;
+		}
+		sim->optionNames[sim->numberOfOptions]=option;
+		sim->optionValues[sim->numberOfOptions++]=value;
+	}
+	return sim;
+}
+
+// Adds a program to a simulation not started yet. Returns 0 if added
+int sim_load_program(SIM *sim, const char *name, SIMTIME arrivalTime) {
+	// Entry 0 of the program list is for the SIP
+	if (sim==NULL || sim->state!=SIM_NEW || sim->numberOfPrograms>=PROGRAMSMAXNUMBER-1)
+		return -1;
+	sim->programNames[sim->numberOfPrograms]=strdup(name);
+	snprintf(sim->programArrivals[sim->numberOfPrograms], sizeof(sim->programArrivals[0]), "%lld", arrivalTime);
+	sim->numberOfPrograms++;
+	return 0;
+}
+
+// Runs up to cycles instruction cycles. Returns the state of the simulation
+int sim_step(SIM *sim, int cycles) {
+	int state;
+
+	if (sim==NULL || sim->state==SIM_ERROR)
+		return SIM_ERROR;
+	pthread_mutex_lock(&libraryMutex);
+	if (setjmp(libraryFatalError)==0) {
+		Library_Bring(sim);
+		while (cycles-->0 && sim->state==SIM_RUNNING)
+			Library_Cycle(sim);
+	}
+	else
+		Library_Failed(sim);
+	state=sim->state;
+	pthread_mutex_unlock(&libraryMutex);
+	return state;
+}
+
+// Runs until the clock reaches tick. Returns the state of the simulation
+int sim_run_until(SIM *sim, SIMTIME tick) {
+	int state;
+
+	if (sim==NULL || sim->state==SIM_ERROR)
+		return SIM_ERROR;
+	pthread_mutex_lock(&libraryMutex);
+	if (setjmp(libraryFatalError)==0) {
+		Library_Bring(sim);
+		while (sim->state==SIM_RUNNING && Clock_GetTime()<tick)
+			Library_Cycle(sim);
+	}
+	else
+		Library_Failed(sim);
+	state=sim->state;
+	pthread_mutex_unlock(&libraryMutex);
+	return state;
+}
+
+// The figures of the metrics report up to now. Returns the state of the simulation
+int sim_get_metrics(SIM *sim, METRICS_SUMMARY *summary) {
+	int state;
+
+	if (sim==NULL || summary==NULL || sim->state==SIM_ERROR)
+		return SIM_ERROR;
+	pthread_mutex_lock(&libraryMutex);
+	if (setjmp(libraryFatalError)==0) {
+		Library_Bring(sim);
+		Metrics_GetSummary(summary);
+	}
+	else
+		Library_Failed(sim);
+	state=sim->state;
+	pthread_mutex_unlock(&libraryMutex);
+	return state;
+}
+
+void sim_destroy(SIM *sim) {
+	int i;
+
+	if (sim==NULL)
+		return;
+	pthread_mutex_lock(&libraryMutex);
+	// The programs of a failed simulation were freed when it failed
+	if (sim->state!=SIM_NEW && sim->state!=SIM_ERROR)
+		Library_FreePrograms(currentSim==sim ? programList : sim->savedProgramList);
+	if (currentSim==sim)
+		currentSim=NULL;
+	pthread_mutex_unlock(&libraryMutex);
+	for (i=0; i<sim->numberOfPrograms; i++)
+		free(sim->programNames[i]);
+	free(sim->savedState);
+	free(sim->configuration);
+	free(sim);
+}
+
+void Library_FreePrograms(PROGRAMS_DATA **list) {
+	int i;
+
+	for (i=0; i<PROGRAMSMAXNUMBER; i++) {
+		if (list[i]==NULL)
+			continue;
+		// The name of the SIP is a constant
+		if (i>0)
+			free(list[i]->executableName);
+		free(list[i]);
+		list[i]=NULL;
+	}
+}
+
+// Called by Simulator_FatalError: back to the sim_* call that was running the simulation
+void Library_FatalError() {
+	longjmp(libraryFatalError, 1);
+}
+
+// The simulation that had a fatal error cannot go on. The globals are left to the next
+// one brought into them, since the others were put aside before
+void Library_Failed(SIM *sim) {
+	sim->state=SIM_ERROR;
+	Library_FreePrograms(programList);
+	memset(sim->savedProgramList, 0, sizeof(sim->savedProgramList));
+	currentSim=NULL;
+}
+
+// The simulation in the globals is put aside and the given one is brought into them
+void Library_Bring(SIM *sim) {
+	if (currentSim==sim)
+		return;
+	if (currentSim!=NULL) {
+		Checkpoint_SaveState(currentSim->savedState);
+		memcpy(currentSim->savedProgramList, programList, sizeof(currentSim->savedProgramList));
+		Library_SaveGlobals(currentSim);
+	}
+	if (sim->state==SIM_NEW)
+		Library_Boot(sim);
+	else {
+		Checkpoint_RestoreState(sim->savedState);
+		memcpy(programList, sim->savedProgramList, sizeof(sim->savedProgramList));
+		Library_RestoreGlobals(sim);
+	}
+	currentSim=sim;
+}
+
+// Globals of a simulation out of the checkpoint blocks: options read while it runs and
+// the progress of its checkpoints
+void Library_SaveGlobals(SIM *sim) {
+	sim->initialPID=initialPID;
+	sim->intervalBetweenInterrupts=intervalBetweenInterrupts;
+	sim->endSimulationTime=endSimulationTime;
+	sim->checkpointAt=checkpointAt;
+	sim->checkpointFile=checkpointFile;
+	sim->checkpointInterval=checkpointInterval;
+	sim->verifyCheckpoint=verifyCheckpoint;
+	sim->checkpointCache=checkpointCache;
+	sim->nextCheckpointTick=nextCheckpointTick;
+	sim->verifyTime=verifyTime;
+	sim->nextCacheArrival=nextCacheArrival;
+}
+
+void Library_RestoreGlobals(SIM *sim) {
+	initialPID=sim->initialPID;
+	intervalBetweenInterrupts=sim->intervalBetweenInterrupts;
+	endSimulationTime=sim->endSimulationTime;
+	checkpointAt=sim->checkpointAt;
+	checkpointFile=sim->checkpointFile;
+	checkpointInterval=sim->checkpointInterval;
+	verifyCheckpoint=sim->verifyCheckpoint;
+	checkpointCache=sim->checkpointCache;
+	nextCheckpointTick=sim->nextCheckpointTick;
+	verifyTime=sim->verifyTime;
+	nextCacheArrival=sim->nextCacheArrival;
+}
+
+// As ComputerSystem_PowerOn, from the initial globals and up to the instruction cycle loop
+void Library_Boot(SIM *sim) {
+	char *argv[2*PROGRAMSMAXNUMBER+1];
+	int i, argc=1, daemonsBaseIndex, numberOfMessages;
+
+	if (initialState==NULL) {
+		initialState=(char *) malloc(Checkpoint_StateSize());
+		Checkpoint_SaveState(initialState);
+		Library_SaveGlobals(&libraryDefaults);
+	}
+	else
+		Checkpoint_RestoreState(initialState);
+	Library_RestoreGlobals(&libraryDefaults);
+	// Globals may keep pointing to the values after the simulation is destroyed
+	for (i=0; i<sim->numberOfOptions; i++)
+		Simulator_SetOption(sim->optionNames[i], sim->optionValues[i]==NULL ? NULL : strdup(sim->optionValues[i]));
+
+	if (!libraryOutputStarted) {
+		Log_Initialize();
+		FlightRecorder_Initialize();
+		numberOfMessages=Messages_LoadCatalogue();
+		if (STUDENT_MESSAGES_FILE[0]!=0)
+			Messages_Load_Messages(numberOfMessages, STUDENT_MESSAGES_FILE);
+		libraryOutputStarted=1;
+	}
+
+	argv[0]="Simulator";
+	for (i=0; i<sim->numberOfPrograms; i++) {
+		argv[argc++]=sim->programNames[i];
+		argv[argc++]=sim->programArrivals[i];
+	}
+	daemonsBaseIndex=ComputerSystem_ObtainProgramList(argc, argv, 1);
+	Clock_Initialize();
+	OperatingSystem_Initialize(daemonsBaseIndex);
+	sim->savedState=(char *) malloc(Checkpoint_StateSize());
+	sim->state=Processor_PSW_BitState(POWEROFF_BIT) ? SIM_ENDED : SIM_RUNNING;
+}
+
+// As an iteration of Processor_InstructionCycleLoop
+void Library_Cycle(SIM *sim) {
+	if (Processor_FetchInstruction()==CPU_SUCCESS)
+		Processor_DecodeAndExecuteInstruction();
+	if (interruptLines_CPU)
+		Processor_ManageInterrupts();
+	if (Processor_PSW_BitState(POWEROFF_BIT))
+		sim->state=SIM_ENDED;
+}
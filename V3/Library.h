@@ -0,0 +1,65 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include "Simulator.h"
+#include "ComputerSystem.h"
+#include "Metrics.h"
+
+// The simulator as a library (libsimulator.a): any number of independent simulations in
+// one process. The simulator keeps the simulation it runs in the globals of its modules;
+// every other one is a copy of them (the blocks of a checkpoint), its programs and the
+// options it was created with, brought in and out of the globals as needed. Because of
+// that, every sim_* call takes one lock for the whole library: simulations can be driven
+// from several threads, but they never run in parallel, so a thread pool gets no speedup
+// (run separate processes for that, as simsweep does). Options about the output (log,
+// sections, messages) are shared by all of them
+//   SIM *sim=sim_create("--intervalBetweenInterrupts=7 --tickless");
+//   sim_load_program(sim, "prog-V1-E3", 0);
+//   while (sim_step(sim, 1000)==SIM_RUNNING);
+//   sim_get_metrics(sim, &summary);
+//   sim_destroy(sim);
+// A fatal error of the simulator (no operating system code, an unusable checkpoint) only
+// ends the simulation that had it: that call and the next ones on it return SIM_ERROR
+
+// States of a simulation
+enum SimStates { SIM_ERROR=-1, SIM_NEW, SIM_RUNNING, SIM_ENDED };
+
+#define LIBRARY_MAXOPTIONS 32
+
+typedef struct {
+	int state;
+	char *configuration;			// Copy of the options given, split in place
+	int numberOfOptions;
+	char *optionNames[LIBRARY_MAXOPTIONS];
+	char *optionValues[LIBRARY_MAXOPTIONS];
+	int numberOfPrograms;			// Programs loaded before the first step
+	char *programNames[PROGRAMSMAXNUMBER];
+	char programArrivals[PROGRAMSMAXNUMBER][24];
+	// Out of the globals while another simulation runs
+	char *savedState;
+	PROGRAMS_DATA *savedProgramList[PROGRAMSMAXNUMBER];
+	int initialPID;
+	int intervalBetweenInterrupts;
+	SIMTIME endSimulationTime;
+	SIMTIME checkpointAt;
+	char *checkpointFile;
+	int checkpointInterval;
+	char *verifyCheckpoint;
+	char *checkpointCache;
+	SIMTIME nextCheckpointTick;
+	SIMTIME verifyTime;
+	SIMTIME nextCacheArrival;
+} SIM;
+
+// Functions prototypes
+SIM *sim_create(const char *);
+int sim_load_program(SIM *, const char *, SIMTIME);
+int sim_step(SIM *, int);
+int sim_run_until(SIM *, SIMTIME);
+int sim_get_metrics(SIM *, METRICS_SUMMARY *);
+void sim_destroy(SIM *);
+
+// For Simulator_FatalError
+void Library_FatalError();
+
+#endif
@@ -0,0 +1,370 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#include "Log.h"
+#include "BinaryLog.h"
+#include "Simulator.h"
+
+char defaultLogSink[]="stdout";
+char defaultLogFile[]="simulator.log";
+char *logSink=defaultLogSink;
+char *logFile=defaultLogFile;
+char defaultLogFormat[]="text";
+char *logFormat=defaultLogFormat;
+int logBinary=0;
+
+// The ring. Records are [section][length: 2 bytes][text]. head is only written by
+// the simulation thread and tail only by the writer thread
+char logRing[LOGRINGSIZE];
+atomic_ullong logHead=0;
+atomic_ullong logTail=0;
+
+// Flush handshake and termination of the writer thread
+atomic_ullong logFlushRequested=0;
+atomic_ullong logFlushDone=0;
+atomic_int logStopRequested=0;
+
+// A thread with nothing to do sleeps until the other one wakes it up. The producer waits
+// for progress of the writer (ring drained, flush done). The writer waits for a flush
+// request, the stop or LOGWAKEUPSIZE bytes in the ring, and wakes up by itself every
+// LOGWRITERPERIOD if there is less: waking it up for every record would cost more than
+// writing it. Each side only takes the lock when the other one is asleep
+pthread_mutex_t logLock=PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t logWriterWakeUp=PTHREAD_COND_INITIALIZER;
+pthread_cond_t logProducerWakeUp=PTHREAD_COND_INITIALIZER;
+atomic_int logWriterSleeping=0;
+atomic_int logProducerSleeping=0;
+atomic_ullong logWriterProgress=0;
+
+int logInitialized=0;
+int logSinkType=LOGSINK_STDOUT;
+pthread_t logWriter;
+
+// Sinks: one stream, or one per section letter for LOGSINK_SECTIONS
+FILE *logStream=NULL;
+FILE *logSectionStreams[LOGMAXSTREAMS];
+
+// Internal Functions prototypes
+void *Log_WriterThread(void *);
+void Log_RingCopyIn(unsigned long long, const void *, int);
+void Log_RingCopyOut(unsigned long long, void *, int);
+void Log_Emit(char, const char *, int);
+void Log_FlushSinks();
+void Log_WakeWriter(int);
+void Log_WaitForWriter(unsigned long long);
+void Log_WriterProgressed();
+void Log_WriterWait(unsigned long long);
+
+// Selects the sink and starts the writer thread
+void Log_Initialize() {
+	if (logInitialized)
+		return;
+	if (strcmp(logSink, "file")==0) {
+		logSinkType=LOGSINK_FILE;
+		logStream=fopen(logFile, "w");
+		if (logStream==NULL) {
+			printf("Log file %s cannot be created, using stdout\n", logFile);
+			logSinkType=LOGSINK_STDOUT;
+		}
+		else
+			setvbuf(logStream, NULL, _IOFBF, LOGRINGSIZE);
+	}
+	else if (strcmp(logSink, "null")==0)
+		logSinkType=LOGSINK_NULL;
+	else if (strcmp(logSink, "sections")==0)
+		logSinkType=LOGSINK_SECTIONS;
+	if (logSinkType==LOGSINK_STDOUT)
+		logStream=stdout;
+	logBinary=strcmp(logFormat, "binary")==0;
+
+	if (pthread_create(&logWriter, NULL, Log_WriterThread, NULL)!=0) {
+		printf("Log writer thread cannot be created\n");
+		Simulator_FatalError(1);
+		return;
+	}
+	logInitialized=1;
+	// exit() from any point of the simulation must not lose pending output
+	atexit(Log_Terminate);
+}
+
+// Copies a record into the ring, waiting only if the ring is full
+void Log_Write(char section, const char *text, int length) {
+	unsigned long long head, progress;
+	unsigned short recordLength;
+	int chunk;
+
+	if (!logInitialized) { // Output before the pipeline starts goes directly
+		fwrite(text, 1, length, stdout);
+		return;
+	}
+	head=atomic_load_explicit(&logHead, memory_order_relaxed);
+	while (length>0) {
+		chunk=length>LOGMAXRECORD ? LOGMAXRECORD : length;
+		while (1) {
+			progress=atomic_load(&logWriterProgress);
+			if (LOGRINGSIZE-(head-atomic_load_explicit(&logTail, memory_order_acquire)) >= chunk+3)
+				break;
+			Log_WaitForWriter(progress);
+		}
+		recordLength=chunk;
+		Log_RingCopyIn(head, &section, 1);
+		Log_RingCopyIn(head+1, &recordLength, 2);
+		Log_RingCopyIn(head+3, text, chunk);
+		head+=chunk+3;
+		atomic_store(&logHead, head);
+		Log_WakeWriter(head-atomic_load_explicit(&logTail, memory_order_relaxed)>=LOGWAKEUPSIZE);
+		text+=chunk;
+		length-=chunk;
+	}
+}
+
+void Log_Printf(char section, const char *format, ...) {
+	char text[LOGMAXRECORD];
+	int length;
+	va_list lp;
+
+	va_start(lp, format);
+	length=vsnprintf(text, sizeof(text), format, lp);
+	va_end(lp);
+	if (length>=(int) sizeof(text))
+		length=sizeof(text)-1;
+	if (length<=0)
+		return;
+	if (logBinary)
+		BinaryLog_Text(section, text, length);
+	else
+		Log_Write(section, text, length);
+}
+
+// Stream where the records of a section end up
+int Log_Stream(char section) {
+	if (logSinkType!=LOGSINK_SECTIONS)
+		return 0;
+	return (section>='a' && section<='z') ? section-'a' : 0;
+}
+
+// Waits until everything written so far has reached the sinks
+void Log_Flush() {
+	unsigned long long request, progress;
+
+	if (!logInitialized)
+		return;
+	request=atomic_fetch_add(&logFlushRequested, 1)+1;
+	Log_WakeWriter(1);
+	while (1) {
+		progress=atomic_load(&logWriterProgress);
+		if (atomic_load_explicit(&logFlushDone, memory_order_acquire) >= request)
+			break;
+		Log_WaitForWriter(progress);
+	}
+}
+
+// Drains the ring, stops the writer thread and closes the sinks
+void Log_Terminate() {
+	int i;
+
+	if (!logInitialized)
+		return;
+	Log_Flush();
+	atomic_store(&logStopRequested, 1);
+	Log_WakeWriter(1);
+	pthread_join(logWriter, NULL);
+	logInitialized=0;
+	if (logSinkType==LOGSINK_FILE)
+		fclose(logStream);
+	for (i=0; i<LOGMAXSTREAMS; i++)
+		if (logSectionStreams[i]!=NULL) {
+			fclose(logSectionStreams[i]);
+			logSectionStreams[i]=NULL;
+		}
+	fflush(stdout);
+}
+
+// A forked child has the ring but not the writer thread. The output so far belongs to
+// the parent (flushed before the fork), so the child starts again with its own sink
+void Log_Restart() {
+	int i;
+
+	logInitialized=0;
+	atomic_store(&logHead, 0);
+	atomic_store(&logTail, 0);
+	atomic_store(&logFlushRequested, 0);
+	atomic_store(&logFlushDone, 0);
+	atomic_store(&logStopRequested, 0);
+	// The lock may have been held by the writer thread, which the child does not have
+	pthread_mutex_init(&logLock, NULL);
+	pthread_cond_init(&logWriterWakeUp, NULL);
+	pthread_cond_init(&logProducerWakeUp, NULL);
+	atomic_store(&logWriterSleeping, 0);
+	atomic_store(&logProducerSleeping, 0);
+	if (logSinkType==LOGSINK_FILE)
+		fclose(logStream);
+	for (i=0; i<LOGMAXSTREAMS; i++)
+		if (logSectionStreams[i]!=NULL) {
+			fclose(logSectionStreams[i]);
+			logSectionStreams[i]=NULL;
+		}
+	logSinkType=LOGSINK_STDOUT;
+	logStream=NULL;
+	BinaryLog_Reset();
+	Log_Initialize();
+}
+
+void *Log_WriterThread(void *unused) {
+	char text[LOGMAXRECORD];
+	char section;
+	unsigned short recordLength;
+	unsigned long long tail=atomic_load(&logTail), head, request;
+	int pending=0;
+
+	while (1) {
+		head=atomic_load_explicit(&logHead, memory_order_acquire);
+		if (tail<head) {
+			while (tail<head) {
+				Log_RingCopyOut(tail, &section, 1);
+				Log_RingCopyOut(tail+1, &recordLength, 2);
+				Log_RingCopyOut(tail+3, text, recordLength);
+				tail+=recordLength+3;
+				atomic_store_explicit(&logTail, tail, memory_order_release);
+				Log_Emit(section, text, recordLength);
+			}
+			pending=1;
+			Log_WriterProgressed();
+		}
+		request=atomic_load_explicit(&logFlushRequested, memory_order_acquire);
+		if (request>atomic_load_explicit(&logFlushDone, memory_order_relaxed)) {
+			// The requester waits, so the ring holds everything written before the request
+			if (atomic_load_explicit(&logHead, memory_order_acquire)>tail)
+				continue;
+			Log_FlushSinks();
+			pending=0;
+			atomic_store_explicit(&logFlushDone, request, memory_order_release);
+			Log_WriterProgressed();
+		}
+		else if (atomic_load(&logStopRequested))
+			break;
+		else {
+			// Nothing to do: a terminal shows the output as soon as the simulation pauses
+			if (pending && logSinkType==LOGSINK_STDOUT) {
+				fflush(stdout);
+				pending=0;
+			}
+			Log_WriterWait(tail);
+		}
+	}
+	return unused;
+}
+
+void Log_RingCopyIn(unsigned long long position, const void *data, int length) {
+	int offset=position & (LOGRINGSIZE-1);
+	int first=LOGRINGSIZE-offset;
+
+	if (first>=length)
+		memcpy(&logRing[offset], data, length);
+	else {
+		memcpy(&logRing[offset], data, first);
+		memcpy(logRing, (const char *) data+first, length-first);
+	}
+}
+
+void Log_RingCopyOut(unsigned long long position, void *data, int length) {
+	int offset=position & (LOGRINGSIZE-1);
+	int first=LOGRINGSIZE-offset;
+
+	if (first>=length)
+		memcpy(data, &logRing[offset], length);
+	else {
+		memcpy(data, &logRing[offset], first);
+		memcpy((char *) data+first, logRing, length-first);
+	}
+}
+
+// Writes a record into the sink (only called by the writer thread)
+void Log_Emit(char section, const char *text, int length) {
+	char fileName[256];
+	int index;
+
+	switch (logSinkType) {
+		case LOGSINK_NULL:
+			return;
+		case LOGSINK_SECTIONS:
+			index=Log_Stream(section);
+			if (logSectionStreams[index]==NULL) {
+				snprintf(fileName, sizeof(fileName), "%s.%c", logFile, 'a'+index);
+				logSectionStreams[index]=fopen(fileName, "w");
+				if (logSectionStreams[index]==NULL)
+					return;
+			}
+			fwrite(text, 1, length, logSectionStreams[index]);
+			return;
+		default:
+			fwrite(text, 1, length, logStream);
+	}
+}
+
+void Log_FlushSinks() {
+	int i;
+
+	if (logStream!=NULL)
+		fflush(logStream);
+	for (i=0; i<LOGMAXSTREAMS; i++)
+		if (logSectionStreams[i]!=NULL)
+			fflush(logSectionStreams[i]);
+}
+
+// Called by the producer after a new record (needed only if enough of them are waiting),
+// a flush request or the stop
+void Log_WakeWriter(int needed) {
+	if (!needed || !atomic_load(&logWriterSleeping))
+		return;
+	pthread_mutex_lock(&logLock);
+	pthread_cond_signal(&logWriterWakeUp);
+	pthread_mutex_unlock(&logLock);
+}
+
+// The producer sleeps until the writer has made progress since it read progress
+void Log_WaitForWriter(unsigned long long progress) {
+	pthread_mutex_lock(&logLock);
+	atomic_store(&logProducerSleeping, 1);
+	while (atomic_load(&logWriterProgress)==progress)
+		pthread_cond_wait(&logProducerWakeUp, &logLock);
+	atomic_store(&logProducerSleeping, 0);
+	pthread_mutex_unlock(&logLock);
+}
+
+// Called by the writer after draining records or doing a flush
+void Log_WriterProgressed() {
+	atomic_fetch_add(&logWriterProgress, 1);
+	if (!atomic_load(&logProducerSleeping))
+		return;
+	pthread_mutex_lock(&logLock);
+	pthread_cond_signal(&logProducerWakeUp);
+	pthread_mutex_unlock(&logLock);
+}
+
+// The writer sleeps until LOGWAKEUPSIZE bytes are past tail, a flush request or the stop,
+// or for LOGWRITERPERIOD if there is anything past tail
+void Log_WriterWait(unsigned long long tail) {
+	struct timespec until;
+
+	pthread_mutex_lock(&logLock);
+	atomic_store(&logWriterSleeping, 1);
+	while (atomic_load(&logHead)-tail<LOGWAKEUPSIZE && !atomic_load(&logStopRequested)
+	 && atomic_load(&logFlushRequested)==atomic_load_explicit(&logFlushDone, memory_order_relaxed)) {
+		clock_gettime(CLOCK_REALTIME, &until);
+		until.tv_nsec+=LOGWRITERPERIOD;
+		if (until.tv_nsec>=1000000000) {
+			until.tv_sec++;
+			until.tv_nsec-=1000000000;
+		}
+		if (pthread_cond_timedwait(&logWriterWakeUp, &logLock, &until)==ETIMEDOUT && atomic_load(&logHead)!=tail)
+			break;
+	}
+	atomic_store(&logWriterSleeping, 0);
+	pthread_mutex_unlock(&logLock);
+}
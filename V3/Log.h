@@ -0,0 +1,40 @@
+#ifndef LOG_H
+#define LOG_H
+
+// Simulator output goes through a single-producer/single-consumer ring: the simulation
+// thread only copies records into it and a writer thread drains them into the sink
+
+// Ring capacity in bytes (a power of two) and maximum size of one record
+#define LOGRINGSIZE (1 << 20)
+#define LOGMAXRECORD 4096
+
+// The writer thread is woken up when this many bytes are waiting in the ring; with fewer,
+// it drains them every LOGWRITERPERIOD nanoseconds
+#define LOGWAKEUPSIZE (LOGRINGSIZE/4)
+#define LOGWRITERPERIOD 10000000
+
+// Sinks for the output
+enum LogSinks { LOGSINK_STDOUT, LOGSINK_FILE, LOGSINK_NULL, LOGSINK_SECTIONS };
+
+// Number of output streams: one per section letter with the sections sink
+#define LOGMAXSTREAMS 26
+
+// Functions prototypes
+void Log_Initialize();
+void Log_Write(char, const char *, int);
+void Log_Printf(char, const char *, ...);
+int Log_Stream(char);
+void Log_Flush();
+void Log_Terminate();
+void Log_Restart();
+
+// Sink name (stdout, file, null or sections) and file name for the file sink,
+// also used as prefix of the per-section files
+extern char *logSink;
+extern char *logFile;
+
+// Output format: "text" or "binary" (see BinaryLog.h). logBinary is set by Log_Initialize
+extern char *logFormat;
+extern int logBinary;
+
+#endif
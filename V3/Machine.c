@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <string.h>
+#include "Machine.h"
+#include "ComputerSystem.h"
+#include "FlightRecorder.h"
+#include "Log.h"
+
+extern int registerPC_CPU;
+extern int registerAccumulator_CPU;
+extern BUSDATACELL registerIR_CPU;
+extern unsigned int registerPSW_CPU;
+extern int registerMAR_CPU;
+extern BUSDATACELL registerMBR_CPU;
+extern int registerCTRL_CPU;
+extern int registerA_CPU;
+extern int interruptLines_CPU;
+extern int interruptVectorTable[];
+extern int registerBase_MMU;
+extern int registerLimit_MMU;
+extern int registerMAR_MMU;
+extern int registerCTRL_MMU;
+extern MEMORYCELL mainMemory[];
+extern int registerMAR_MainMemory;
+extern MEMORYCELL registerMBR_MainMemory;
+extern int registerCTRL_MainMemory;
+extern SIMTIME tics;
+
+int lockstep=0;
+
+// Machines of the lockstep: the bus-accurate one and the fast one
+MACHINE lockstepMachines[2];
+
+void Machine_Save(MACHINE *machine) {
+	machine->registerPC=registerPC_CPU;
+	machine->registerAccumulator=registerAccumulator_CPU;
+	machine->registerIR=registerIR_CPU;
+	machine->registerPSW=registerPSW_CPU;
+	machine->registerMAR=registerMAR_CPU;
+	machine->registerMBR=registerMBR_CPU;
+	machine->registerCTRL=registerCTRL_CPU;
+	machine->registerA=registerA_CPU;
+	machine->interruptLines=interruptLines_CPU;
+	memcpy(machine->interruptVectorTable, interruptVectorTable, sizeof(machine->interruptVectorTable));
+	machine->registerBase_MMU=registerBase_MMU;
+	machine->registerLimit_MMU=registerLimit_MMU;
+	machine->registerMAR_MMU=registerMAR_MMU;
+	machine->registerCTRL_MMU=registerCTRL_MMU;
+	memcpy(machine->mainMemory, mainMemory, sizeof(machine->mainMemory));
+	machine->registerMAR_MainMemory=registerMAR_MainMemory;
+	machine->registerMBR_MainMemory=registerMBR_MainMemory;
+	machine->registerCTRL_MainMemory=registerCTRL_MainMemory;
+	machine->tics=tics;
+}
+
+void Machine_Restore(MACHINE *machine) {
+	registerPC_CPU=machine->registerPC;
+	registerAccumulator_CPU=machine->registerAccumulator;
+	registerIR_CPU=machine->registerIR;
+	registerPSW_CPU=machine->registerPSW;
+	registerMAR_CPU=machine->registerMAR;
+	registerMBR_CPU=machine->registerMBR;
+	registerCTRL_CPU=machine->registerCTRL;
+	registerA_CPU=machine->registerA;
+	interruptLines_CPU=machine->interruptLines;
+	memcpy(interruptVectorTable, machine->interruptVectorTable, sizeof(machine->interruptVectorTable));
+	registerBase_MMU=machine->registerBase_MMU;
+	registerLimit_MMU=machine->registerLimit_MMU;
+	registerMAR_MMU=machine->registerMAR_MMU;
+	registerCTRL_MMU=machine->registerCTRL_MMU;
+	memcpy(mainMemory, machine->mainMemory, sizeof(machine->mainMemory));
+	registerMAR_MainMemory=machine->registerMAR_MainMemory;
+	registerMBR_MainMemory=machine->registerMBR_MainMemory;
+	registerCTRL_MainMemory=machine->registerCTRL_MainMemory;
+	tics=machine->tics;
+}
+
+// 0 if equal
+int Machine_Compare(MACHINE *first, MACHINE *second) {
+	return memcmp(first, second, sizeof(MACHINE));
+}
+
+// Side by side, the registers and memory cells that differ marked with '*'
+void Machine_DumpLine(const char *name, long long first, long long second) {
+	Log_Printf(ERROR, "%c %-22s %12lld %12lld\n", first!=second ? '*' : ' ', name, first, second);
+}
+
+void Machine_Dump(MACHINE *first, MACHINE *second) {
+	char name[32];
+	int i;
+
+	Log_Printf(ERROR, "  %-22s %12s %12s\n", "", "Buses", "Fast");
+	Machine_DumpLine("PC", first->registerPC, second->registerPC);
+	Machine_DumpLine("Accumulator", first->registerAccumulator, second->registerAccumulator);
+	Machine_DumpLine("IR", first->registerIR.cell, second->registerIR.cell);
+	Machine_DumpLine("PSW", first->registerPSW, second->registerPSW);
+	Machine_DumpLine("MAR", first->registerMAR, second->registerMAR);
+	Machine_DumpLine("MBR", first->registerMBR.cell, second->registerMBR.cell);
+	Machine_DumpLine("CTRL", first->registerCTRL, second->registerCTRL);
+	Machine_DumpLine("A", first->registerA, second->registerA);
+	Machine_DumpLine("Interrupt lines", first->interruptLines, second->interruptLines);
+	for (i=0; i<INTERRUPTTYPES; i++)
+		if (first->interruptVectorTable[i]!=second->interruptVectorTable[i]) {
+			snprintf(name, sizeof(name), "Interrupt vector [%d]", i);
+			Machine_DumpLine(name, first->interruptVectorTable[i], second->interruptVectorTable[i]);
+		}
+	Machine_DumpLine("MMU base", first->registerBase_MMU, second->registerBase_MMU);
+	Machine_DumpLine("MMU limit", first->registerLimit_MMU, second->registerLimit_MMU);
+	Machine_DumpLine("MMU MAR", first->registerMAR_MMU, second->registerMAR_MMU);
+	Machine_DumpLine("MMU CTRL", first->registerCTRL_MMU, second->registerCTRL_MMU);
+	Machine_DumpLine("Main memory MAR", first->registerMAR_MainMemory, second->registerMAR_MainMemory);
+	Machine_DumpLine("Main memory MBR", first->registerMBR_MainMemory, second->registerMBR_MainMemory);
+	Machine_DumpLine("Main memory CTRL", first->registerCTRL_MainMemory, second->registerCTRL_MainMemory);
+	for (i=0; i<MAINMEMORYSIZE; i++)
+		if (first->mainMemory[i]!=second->mainMemory[i]) {
+			snprintf(name, sizeof(name), "Memory [%d]", i);
+			Machine_DumpLine(name, first->mainMemory[i], second->mainMemory[i]);
+		}
+	Machine_DumpLine("Clock", first->tics, second->tics);
+}
+
+// The read is done by the fast engine on a copy of the machine and by the bus-accurate
+// one on the machine itself. If they end different, the simulation stops
+void Machine_LockstepRead() {
+	MACHINE *buses=&lockstepMachines[0], *fast=&lockstepMachines[1];
+
+	Machine_Save(buses);
+	Buses_FastRead_CPU();
+	Machine_Save(fast);
+	Machine_Restore(buses);
+	Processor_BusRead();
+	Machine_Save(buses);
+	if (Machine_Compare(buses, fast)) {
+		ComputerSystem_DebugMessage(99,ERROR,"Lockstep: the fast engine differs from the buses\n");
+		Machine_Dump(buses, fast);
+		FlightRecorder_Dump("Lockstep mismatch");
+		Processor_ActivatePSW_Bit(POWEROFF_BIT);
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include "Simulator.h"
+#include "MainMemory.h"
+#include "Buses.h"
+#include "Processor.h"
+
+// A machine: the registers of the CPU, the MMU and the main memory, the memory cells and
+// the clock. The simulator runs the machine kept in the globals of those modules; other
+// machines are saved copies that can be brought in and out of them
+typedef struct {
+	// CPU
+	int registerPC;
+	int registerAccumulator;
+	BUSDATACELL registerIR;
+	unsigned int registerPSW;
+	int registerMAR;
+	BUSDATACELL registerMBR;
+	int registerCTRL;
+	int registerA;
+	int interruptLines;
+	int interruptVectorTable[INTERRUPTTYPES];
+	// MMU
+	int registerBase_MMU;
+	int registerLimit_MMU;
+	int registerMAR_MMU;
+	int registerCTRL_MMU;
+	// Main memory
+	MEMORYCELL mainMemory[MAINMEMORYSIZE];
+	int registerMAR_MainMemory;
+	MEMORYCELL registerMBR_MainMemory;
+	int registerCTRL_MainMemory;
+	// Clock
+	SIMTIME tics;
+} MACHINE;
+
+// Functions prototypes
+void Machine_Save(MACHINE *);
+void Machine_Restore(MACHINE *);
+int Machine_Compare(MACHINE *, MACHINE *);
+void Machine_Dump(MACHINE *, MACHINE *);
+void Machine_LockstepRead();
+
+// Both engines run every read and are compared
+extern int lockstep;
+
+#endif
@@ -1,6 +1,9 @@
 #include "MainMemory.h"
 #include "Processor.h"
 #include "Buses.h"
+#include "Asserts.h"
+#include "StateHash.h"
+#include "GoldenState.h"
 #include <string.h>
 
 // Main memory can be simulated by a memory cell array
@@ -15,6 +18,9 @@ MEMORYCELL registerMBR_MainMemory;
 
 int registerCTRL_MainMemory;
 
+// Pages written since the last MainMemory_ClearDirtyPages, a bit per page
+unsigned char mainMemoryDirtyPages[(MAINMEMORYPAGES+7)/8];
+
 // Getter for the registerMAR_MainMemory
 int MainMemory_GetMAR() {
   return registerMAR_MainMemory;
@@ -54,7 +60,11 @@ void MainMemory_SetCTRL(int ctrl) {
       // To write in a memory cell, the MAR and MBR registers are used, set by the processor,
       // as described previously 
   		case CTRLWRITE:
+        StateHash_MemoryWritten(registerMAR_MainMemory, mainMemory[registerMAR_MainMemory], registerMBR_MainMemory);
         memcpy((void *) (&mainMemory[registerMAR_MainMemory]), (void *) (&registerMBR_MainMemory), sizeof(MEMORYCELL));
+        Asserts_MemoryWritten(registerMAR_MainMemory);
+        GoldenState_MemoryWritten(registerMAR_MainMemory);
+        mainMemoryDirtyPages[registerMAR_MainMemory/MAINMEMORYPAGESIZE/8] |= 1 << (registerMAR_MainMemory/MAINMEMORYPAGESIZE%8);
     		break;
   		default:
   			registerCTRL_MainMemory |= CTRL_FAIL;
@@ -66,3 +76,10 @@ void MainMemory_SetCTRL(int ctrl) {
   	Buses_write_ControlBus_From_To(MAINMEMORY,CPU);
 }
 
+int MainMemory_PageIsDirty(int page) {
+	return (mainMemoryDirtyPages[page/8] >> (page%8)) & 1;
+}
+
+void MainMemory_ClearDirtyPages() {
+	memset(mainMemoryDirtyPages, 0, sizeof(mainMemoryDirtyPages));
+}
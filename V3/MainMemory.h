@@ -8,6 +8,11 @@
 // A memory cell is capable of storing a MEMORYCELL TYPE
 typedef int MEMORYCELL;
 
+// Writes are tracked by pages of MAINMEMORYPAGESIZE cells (the last one may be shorter):
+// a bit per page tells if it has been written since the bits were cleared
+#define MAINMEMORYPAGESIZE 16
+#define MAINMEMORYPAGES ((MAINMEMORYSIZE+MAINMEMORYPAGESIZE-1)/MAINMEMORYPAGESIZE)
+
 // Function prototypes
 
 int MainMemory_GetMAR();
@@ -16,5 +21,7 @@ void MainMemory_GetMBR(MEMORYCELL *);
 void MainMemory_SetMBR(MEMORYCELL *);
 int MainMemory_GetCTRL();
 void MainMemory_SetCTRL(int);
+int MainMemory_PageIsDirty(int);
+void MainMemory_ClearDirtyPages();
 
 #endif
\ No newline at end of file
@@ -2,10 +2,47 @@
 #include <string.h>
 #include "Messages.h"
 #include "ComputerSystem.h"
+#include "Log.h"
 
-int Messages_Set(int , char * );
+void Messages_Compile(DEBUG_MESSAGES *);
+void Messages_CompileTemplate(DEBUG_MESSAGES *, int);
+void Messages_AddSegment(MESSAGE_TEMPLATE *, int *, int, int);
+char *Messages_ColourSequence(char);
+void Messages_Append(const char *, int, char);
+void Messages_AppendInteger(SIMTIME, char);
 
 DEBUG_MESSAGES DebugMessages[NUMBEROFMSGS] = {[0 ... NUMBEROFMSGS-1] = {-1,""}};
+int numberOfDebugMessages=0;
+int messagesPosition[MSGMAXNUMBER] = {[0 ... MSGMAXNUMBER-1] = -1};
+
+// Loads the messages compiled into the simulator (MessagesCatalogue.c, generated from
+// the message files when building), so no file is read at startup
+int Messages_LoadCatalogue() {
+	MESSAGES_CATALOGUE_ENTRY *entry;
+	int i, numberOfmessages=0, fileMessages=0;
+
+	for (entry=messagesCatalogue; entry->format!=NULL; entry++) {
+		switch (Messages_Set(entry->number, entry->format)) {
+			case -1:
+				ComputerSystem_DebugMessage(65,POWERON);
+				break;
+			case -2:
+				ComputerSystem_DebugMessage(66,POWERON,entry->number);
+				break;
+			default:
+				numberOfmessages++;
+				fileMessages++;
+		}
+		if (entry[1].file==NULL || strcmp(entry[1].file, entry->file)) {
+			ComputerSystem_DebugMessage(63,POWERON,fileMessages,entry->file);
+			fileMessages=0;
+		}
+	}
+	// A message file given at run time replaces them
+	for (i=0; i<numberOfDebugMessages; i++)
+		DebugMessages[i].embedded=1;
+	return numberOfmessages;
+}
 
 int Messages_Load_Messages(int numberOfmessages, char * nameFileMessage) {
 
@@ -29,7 +66,7 @@ int Messages_Load_Messages(int numberOfmessages, char * nameFileMessage) {
 		number=strtok(lineRead,",");
  		if ((number!=NULL) && (number[0]!='/') && (number[0]!='\n') && (number[0]!='\r')) {
 	  		rc=sscanf(number,"%d",&msgNumber);
-	    	if (rc==0){
+	    	if (rc<=0 || msgNumber<0 || msgNumber>=MSGMAXNUMBER){
 					// printf("Illegal Message Number in line %d of file %s\n",lineNumber,nameFileMessage);
 					ComputerSystem_DebugMessage(60,POWERON,lineNumber,nameFileMessage);
 					continue;
@@ -66,30 +103,219 @@ int Messages_Load_Messages(int numberOfmessages, char * nameFileMessage) {
   return numberOfmessages;
 }
 
+// Direct index from message number to position in DebugMessages
 int Messages_Get_Pos(int number) {
-	int pos  = number % NUMBEROFMSGS;
-	int i;
-	for (i=0; (DebugMessages[pos].number !=-1) && (DebugMessages[pos].number !=number) && (i < NUMBEROFMSGS); i++) 
-		pos=(pos+1)%NUMBEROFMSGS;
- 	if (DebugMessages[pos].number==number)
- 		return pos;
-
-	return -1;
+	if (number<0 || number>=MSGMAXNUMBER)
+		return -1;
+	return messagesPosition[number];
 }
 
+// Stores and compiles a message. A message of the catalogue is replaced
+// return position/-1/-2  ok/no room or illegal number/duplicated
 int Messages_Set(int msgNumber, char * text) {
-	int posBase = msgNumber % NUMBEROFMSGS;
-	int i, position=posBase;
-
-	for (i=0;i<NUMBEROFMSGS && DebugMessages[position].number!=-1 && DebugMessages[position].number!=msgNumber;i++) 
-		position=(posBase+i)%NUMBEROFMSGS; 
-	if (DebugMessages[position].number==-1) {
-		strcpy(DebugMessages[position].format,text);
-		DebugMessages[position].number=msgNumber;
-		return position;
+	int position;
+
+	if (msgNumber<0 || msgNumber>=MSGMAXNUMBER)
+		return -1;
+	position=messagesPosition[msgNumber];
+	if (position==-1) {
+		if (numberOfDebugMessages==NUMBEROFMSGS)
+			return -1;
+		position=numberOfDebugMessages++;
+		messagesPosition[msgNumber]=position;
+	}
+	else if (!DebugMessages[position].embedded)
+		return -2;
+	strcpy(DebugMessages[position].format,text);
+	DebugMessages[position].number=msgNumber;
+	DebugMessages[position].embedded=0;
+	Messages_Compile(&DebugMessages[position]);
+	return position;
+}
+
+// Escape sequence of the colour codes, indexed by code letter
+char *Messages_ColourSequence(char code) {
+	switch (code) {
+		case 'R': return "\x1b[1;31m"; // Text in red
+		case 'G': return "\x1b[1;32m"; // Text in green
+		case 'Y': return "\x1b[1;33m"; // Text in yellow
+		case 'B': return "\x1b[1;34m"; // Text in blue
+		case 'M': return "\x1b[1;35m"; // Text in magenta
+		case 'C': return "\x1b[1;36m"; // Text in cyan
+		case 'W': return "\x1b[1;37m"; // Text in white
+	}
+	return NULL;
+}
+
+// A message format is compiled once, when loaded, into one template for coloured
+// output and another one for plain output
+void Messages_Compile(DEBUG_MESSAGES *message) {
+	Messages_CompileTemplate(message, 0);
+	Messages_CompileTemplate(message, 1);
+}
+
+// Literal text, escapes and colour codes are merged into literal runs. The format ends
+// at its end or at an unknown % directive
+void Messages_CompileTemplate(DEBUG_MESSAGES *message, int coloured) {
+	MESSAGE_TEMPLATE *compiled=&message->compiled[coloured];
+	char *format=message->format;
+	char *colourSequence, *literal;
+	int count, length=0, runStart=0, argumentType, colour=0, youHaveToContinue=1;
+
+	compiled->numberOfSegments=0;
+	message->numberOfArguments=0;
+	for (count=0; youHaveToContinue && format[count]!=0; count++) {
+		literal=NULL;
+		argumentType=ARGUMENT_NONE;
+		switch (format[count]) {
+			case '\\':
+				count++;
+				if (format[count]=='n')
+					literal="\n";
+				else if (format[count]=='t')
+					literal="\t";
+				else if (format[count]!=0)
+					compiled->text[length++]=format[count];
+				else
+					youHaveToContinue=0;
+				break;
+			case '@': // Next color char
+				count++;
+				if (format[count]=='@') {
+					if (colour)
+						literal="\x1b[0m";
+				}
+				else if ((colourSequence=Messages_ColourSequence(format[count]))!=NULL) {
+					colour=1;
+					literal=colourSequence;
+				}
+				else if (format[count]==0)
+					youHaveToContinue=0;
+				if (!coloured)
+					literal=NULL;
+				break;
+			case '%':
+				count++;
+				switch (format[count]) {
+					case 's': argumentType=ARGUMENT_STRING; break;
+					case 'd': argumentType=ARGUMENT_INT; break;
+					case 'l': argumentType=ARGUMENT_SIMTIME; break;
+					case 'f': argumentType=ARGUMENT_DOUBLE; break;
+					case 'c': argumentType=ARGUMENT_CHAR; break;
+					case 'x': argumentType=ARGUMENT_HEX; break;
+					default: youHaveToContinue=0;
+				}
+				break;
+			default:
+				compiled->text[length++]=format[count];
+		}
+		if (literal!=NULL) {
+			strcpy(&compiled->text[length], literal);
+			length+=strlen(literal);
+		}
+		if (argumentType!=ARGUMENT_NONE) {
+			Messages_AddSegment(compiled, &runStart, length, ARGUMENT_NONE);
+			Messages_AddSegment(compiled, &runStart, length, argumentType);
+			message->argumentTypes[message->numberOfArguments++]=argumentType;
+		}
+	}
+	if (coloured && colour) { // Back to the default colour at the end
+		strcpy(&compiled->text[length], "\x1b[0m");
+		length+=strlen("\x1b[0m");
+	}
+	Messages_AddSegment(compiled, &runStart, length, ARGUMENT_NONE);
+}
+
+// Adds the literal run from runStart to length, if not empty, or an argument slot
+void Messages_AddSegment(MESSAGE_TEMPLATE *compiled, int *runStart, int length, int argumentType) {
+	MESSAGE_SEGMENT *segment=&compiled->segments[compiled->numberOfSegments];
+
+	if (argumentType==ARGUMENT_NONE) {
+		if (length==*runStart)
+			return;
+		segment->offset=*runStart;
+		segment->length=length-*runStart;
+		*runStart=length;
+	}
+	segment->argumentType=argumentType;
+	compiled->numberOfSegments++;
+}
+
+// Output buffer of Messages_Write, written into the log with one write when the message is complete
+#define MSGBUFFERSIZE 512
+char messageBuffer[MSGBUFFERSIZE];
+int messageBufferLength;
+
+void Messages_Append(const char *text, int length, char section) {
+	int chunk;
+
+	while (length>0) {
+		if (messageBufferLength==MSGBUFFERSIZE) { // Very long strings go out in pieces
+			Log_Write(section, messageBuffer, messageBufferLength);
+			messageBufferLength=0;
+		}
+		chunk=MSGBUFFERSIZE-messageBufferLength;
+		if (chunk>length)
+			chunk=length;
+		memcpy(&messageBuffer[messageBufferLength], text, chunk);
+		messageBufferLength+=chunk;
+		text+=chunk;
+		length-=chunk;
+	}
+}
+
+// Decimal conversion without printf
+void Messages_AppendInteger(SIMTIME value, char section) {
+	char digits[24];
+	int position=sizeof(digits);
+	unsigned long long magnitude=value<0 ? -(unsigned long long) value : (unsigned long long) value;
+
+	do {
+		digits[--position]='0'+magnitude%10;
+		magnitude/=10;
+	} while (magnitude>0);
+	if (value<0)
+		digits[--position]='-';
+	Messages_Append(&digits[position], sizeof(digits)-position, section);
+}
+
+void Messages_Write(int pos, int coloured, MESSAGE_ARG args[], char section) {
+	MESSAGE_TEMPLATE *compiled=&DebugMessages[pos].compiled[coloured ? 1 : 0];
+	MESSAGE_SEGMENT *segment;
+	int i, argument=0;
+	char text[320]; // Enough for any %f
+
+	messageBufferLength=0;
+	for (i=0; i<compiled->numberOfSegments; i++) {
+		segment=&compiled->segments[i];
+		switch (segment->argumentType) {
+			case ARGUMENT_NONE:
+				Messages_Append(&compiled->text[segment->offset], segment->length, section);
+				continue;
+			case ARGUMENT_STRING:
+				if (args[argument].s==NULL)
+					Messages_Append("(null)", 6, section);
+				else
+					Messages_Append(args[argument].s, strlen(args[argument].s), section);
+				break;
+			case ARGUMENT_INT:
+				Messages_AppendInteger(args[argument].d, section);
+				break;
+			case ARGUMENT_SIMTIME:
+				Messages_AppendInteger(args[argument].l, section);
+				break;
+			case ARGUMENT_DOUBLE:
+				Messages_Append(text, snprintf(text, sizeof(text), "%f", args[argument].f), section);
+				break;
+			case ARGUMENT_CHAR:
+				text[0]=(char) args[argument].d;
+				Messages_Append(text, 1, section);
+				break;
+			case ARGUMENT_HEX:
+				Messages_Append(text, snprintf(text, sizeof(text), "%04X", args[argument].d), section);
+				break;
+		}
+		argument++;
 	}
-	else 
-		if (DebugMessages[position].number==msgNumber)
-			return -2;
-	return -1;
+	Log_Write(section, messageBuffer, messageBufferLength);
 }
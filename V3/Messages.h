@@ -1,20 +1,69 @@
 #ifndef MESSAGES_H
 #define MESSAGES_H
 
+#include "Simulator.h"
+
 #define NUMBEROFMSGS 100
 #define MSGMAXIMUMLENGTH 132
 
-#define TEACHER_MESSAGES_FILE "messagesTCH.txt"
+// Message numbers go from 0 to MSGMAXNUMBER-1, so their positions are found directly
+#define MSGMAXNUMBER 1000
+
+// Limits of a compiled message: every segment comes from at least one format
+// character and a colour code may grow from 2 to 7 characters
+#define MSGMAXSEGMENTS MSGMAXIMUMLENGTH
+#define MSGMAXTEXTLENGTH (4*MSGMAXIMUMLENGTH)
+
+// Types of the argument slots of a message, from its % directives
+enum MessageArgumentTypes { ARGUMENT_NONE=-1, ARGUMENT_STRING, ARGUMENT_INT, ARGUMENT_SIMTIME, ARGUMENT_DOUBLE, ARGUMENT_CHAR, ARGUMENT_HEX };
+
+// A run of literal text (argumentType ARGUMENT_NONE) or the next argument slot
+typedef struct {
+  short offset; // Position of the literal text into the template text
+  short length;
+  char argumentType;
+} MESSAGE_SEGMENT;
+
+// A message format compiled into segments. Escapes and colour codes are already resolved
+typedef struct {
+  int numberOfSegments;
+  MESSAGE_SEGMENT segments[MSGMAXSEGMENTS];
+  char text[MSGMAXTEXTLENGTH];
+} MESSAGE_TEMPLATE;
 
 typedef struct {
   int number;
   char format[MSGMAXIMUMLENGTH];
+  int numberOfArguments;
+  char argumentTypes[MSGMAXIMUMLENGTH];
+  MESSAGE_TEMPLATE compiled[2]; // Without and with colours
+  int embedded; // From the catalogue, so a message file may replace it
 } DEBUG_MESSAGES;
 
+// Entry of the catalogue generated by mkmessages from the message files
+typedef struct {
+  char *file;
+  int number;
+  char *format;
+} MESSAGES_CATALOGUE_ENTRY;
+
+// Value for an argument slot
+typedef union {
+  char *s;
+  int d;
+  SIMTIME l;
+  double f;
+} MESSAGE_ARG;
+
 extern DEBUG_MESSAGES DebugMessages[NUMBEROFMSGS];
+extern MESSAGES_CATALOGUE_ENTRY messagesCatalogue[];
 
 int Messages_Get_Pos(int number);
+int Messages_LoadCatalogue();
 int Messages_Load_Messages(int, char *);
+int Messages_Set(int, char *);
 
-#endif
+// Writes the message in the given position with one write into the log, with colours or not
+void Messages_Write(int, int, MESSAGE_ARG[], char);
 
+#endif
@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <string.h>
+#include "Metrics.h"
+#include "OperatingSystem.h"
+#include "OperatingSystemBase.h"
+#include "Processor.h"
+#include "Clock.h"
+
+char defaultMetricsFormat[]="csv";
+char *metricsFile="";
+char *metricsFormat=defaultMetricsFormat;
+
+// Accounting of every program that has become a process (each program does it at most once),
+// copied from the PCB when the process terminates. PID of that process or NOPROCESS
+PROCESS_ACCOUNTING programAccounting[PROGRAMSMAXNUMBER];
+int processOfProgram[PROGRAMSMAXNUMBER];
+
+// System totals
+SIMTIME ticksWithoutProcess=0;
+SIMTIME numberOfContextSwitches=0;
+
+// Internal Functions prototypes
+void Metrics_ChargeStateTime(PROCESS_ACCOUNTING *, int, SIMTIME);
+void Metrics_CollectLiveProcesses();
+void Metrics_WriteCSV(FILE *);
+void Metrics_WriteJSON(FILE *);
+SIMTIME Metrics_Turnaround(PROCESS_ACCOUNTING *);
+SIMTIME Metrics_Response(PROCESS_ACCOUNTING *);
+SIMTIME Metrics_Waiting(PROCESS_ACCOUNTING *);
+double Metrics_Ratio(SIMTIME, SIMTIME);
+
+// No program has become a process yet
+void Metrics_Initialize() {
+	int i;
+
+	for (i=0; i<PROGRAMSMAXNUMBER; i++)
+		processOfProgram[i]=NOPROCESS;
+}
+
+// Initial accounting of a process in the NEW state
+void Metrics_ProcessCreated(int PID) {
+	PROCESS_ACCOUNTING *accounting=&processTable[PID].accounting;
+	SIMTIME now=Clock_GetTime();
+
+	memset(accounting, 0, sizeof(PROCESS_ACCOUNTING));
+	accounting->arrivalTime=programList[processTable[PID].programListIndex]->arrivalTime;
+	accounting->admissionTime=now;
+	accounting->firstDispatchTime=METRICS_NOTHAPPENED;
+	accounting->exitTime=METRICS_NOTHAPPENED;
+	accounting->lastStateChange=now;
+}
+
+// Time spent in the state being left is added to the process accounting
+void Metrics_ChargeStateTime(PROCESS_ACCOUNTING *accounting, int state, SIMTIME now) {
+	if (state==READY)
+		accounting->readyTicks+=now-accounting->lastStateChange;
+	else if (state==BLOCKED)
+		accounting->blockedTicks+=now-accounting->lastStateChange;
+	accounting->lastStateChange=now;
+}
+
+// Called before the process changes its state to newState
+void Metrics_ProcessStateChange(int PID, int newState) {
+	PROCESS_ACCOUNTING *accounting=&processTable[PID].accounting;
+	SIMTIME now=Clock_GetTime();
+	int programListIndex=processTable[PID].programListIndex;
+
+	Metrics_ChargeStateTime(accounting, processTable[PID].state, now);
+	switch (newState) {
+		case EXECUTING:
+			accounting->numberOfDispatches++;
+			numberOfContextSwitches++;
+			if (accounting->firstDispatchTime==METRICS_NOTHAPPENED)
+				accounting->firstDispatchTime=now;
+			break;
+		case EXIT:
+			accounting->exitTime=now;
+			programAccounting[programListIndex]=*accounting;
+			processOfProgram[programListIndex]=PID;
+			break;
+	}
+}
+
+// Every clock tick is charged to the executing process
+void Metrics_ChargeTick() {
+	int PID=OperatingSystem_GetExecutingProcess();
+
+	if (PID==NOPROCESS)
+		ticksWithoutProcess++;
+	else {
+		processTable[PID].accounting.cpuTicks++;
+		if (!Processor_PSW_BitState(EXECUTION_MODE_BIT))
+			processTable[PID].accounting.userTicks++;
+	}
+}
+
+// Processes not terminated at power off are reported with their accounting up to now
+void Metrics_CollectLiveProcesses() {
+	int PID;
+	PROCESS_ACCOUNTING *accounting;
+
+	for (PID=0; PID<PROCESSTABLEMAXSIZE; PID++)
+		if (processTable[PID].busy && processTable[PID].state!=EXIT) {
+			accounting=&programAccounting[processTable[PID].programListIndex];
+			*accounting=processTable[PID].accounting;
+			Metrics_ChargeStateTime(accounting, processTable[PID].state, Clock_GetTime());
+			processOfProgram[processTable[PID].programListIndex]=PID;
+		}
+}
+
+// Writes the report into metricsFile, if any
+void Metrics_WriteReport() {
+	FILE *reportFile;
+
+	if (metricsFile==NULL || metricsFile[0]=='\0')
+		return;
+	reportFile=fopen(metricsFile, "w");
+	if (reportFile==NULL) {
+		ComputerSystem_DebugMessage(100,ERROR,"Metrics report file cannot be created\n");
+		return;
+	}
+	Metrics_CollectLiveProcesses();
+	if (strcasecmp(metricsFormat, "json")==0)
+		Metrics_WriteJSON(reportFile);
+	else
+		Metrics_WriteCSV(reportFile);
+	fclose(reportFile);
+}
+
+// Time from arrival to termination
+SIMTIME Metrics_Turnaround(PROCESS_ACCOUNTING *accounting) {
+	if (accounting->exitTime==METRICS_NOTHAPPENED)
+		return METRICS_NOTHAPPENED;
+	return accounting->exitTime-accounting->arrivalTime;
+}
+
+// Time from arrival to the first dispatch
+SIMTIME Metrics_Response(PROCESS_ACCOUNTING *accounting) {
+	if (accounting->firstDispatchTime==METRICS_NOTHAPPENED)
+		return METRICS_NOTHAPPENED;
+	return accounting->firstDispatchTime-accounting->arrivalTime;
+}
+
+// Time waiting for the admission plus time into the ready-to-run queues
+SIMTIME Metrics_Waiting(PROCESS_ACCOUNTING *accounting) {
+	return accounting->admissionTime-accounting->arrivalTime+accounting->readyTicks;
+}
+
+double Metrics_Ratio(SIMTIME part, SIMTIME total) {
+	return total>0 ? (double) part/total : 0.0;
+}
+
+// One line per process followed by the system totals, as "name,value" lines
+void Metrics_WriteCSV(FILE *reportFile) {
+	int i;
+	PROCESS_ACCOUNTING *a;
+	SIMTIME totalTicks=Clock_GetTime();
+	SIMTIME sipTicks=processTable[sipID].accounting.cpuTicks;
+
+	fprintf(reportFile, "pid,program,type,arrival,admission,firstDispatch,exit,cpuTicks,userTicks,readyTicks,blockedTicks,"
+		"dispatches,preemptions,yields,sleeps,turnaround,response,waiting\n");
+	for (i=0; i<PROGRAMSMAXNUMBER; i++) {
+		if (processOfProgram[i]==NOPROCESS)
+			continue;
+		a=&programAccounting[i];
+		fprintf(reportFile, "%d,%s,%s,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n",
+			processOfProgram[i], programList[i]->executableName, programList[i]->type==USERPROGRAM?"USER":"DAEMON",
+			a->arrivalTime, a->admissionTime, a->firstDispatchTime, a->exitTime,
+			a->cpuTicks, a->userTicks, a->readyTicks, a->blockedTicks,
+			a->numberOfDispatches, a->numberOfPreemptions, a->numberOfYields, a->numberOfSleeps,
+			Metrics_Turnaround(a), Metrics_Response(a), Metrics_Waiting(a));
+	}
+	fprintf(reportFile, "\nmetric,value\n");
+	fprintf(reportFile, "totalTicks,%lld\n", totalTicks);
+	fprintf(reportFile, "cpuUtilization,%.4f\n", Metrics_Ratio(totalTicks-sipTicks-ticksWithoutProcess, totalTicks));
+	fprintf(reportFile, "idleRatio,%.4f\n", Metrics_Ratio(sipTicks, totalTicks));
+	fprintf(reportFile, "contextSwitches,%lld\n", numberOfContextSwitches);
+	fprintf(reportFile, "contextSwitchesPer1000Ticks,%.4f\n", 1000*Metrics_Ratio(numberOfContextSwitches, totalTicks));
+}
+
+void Metrics_WriteJSON(FILE *reportFile) {
+	int i, first=1;
+	PROCESS_ACCOUNTING *a;
+	SIMTIME totalTicks=Clock_GetTime();
+	SIMTIME sipTicks=processTable[sipID].accounting.cpuTicks;
+
+	fprintf(reportFile, "{\n  \"processes\": [");
+	for (i=0; i<PROGRAMSMAXNUMBER; i++) {
+		if (processOfProgram[i]==NOPROCESS)
+			continue;
+		a=&programAccounting[i];
+		fprintf(reportFile, "%s\n    {\"pid\": %d, \"program\": \"%s\", \"type\": \"%s\", "
+			"\"arrival\": %lld, \"admission\": %lld, \"firstDispatch\": %lld, \"exit\": %lld, "
+			"\"cpuTicks\": %lld, \"userTicks\": %lld, \"readyTicks\": %lld, \"blockedTicks\": %lld, "
+			"\"dispatches\": %lld, \"preemptions\": %lld, \"yields\": %lld, \"sleeps\": %lld, "
+			"\"turnaround\": %lld, \"response\": %lld, \"waiting\": %lld}",
+			first?"":",", processOfProgram[i], programList[i]->executableName, programList[i]->type==USERPROGRAM?"USER":"DAEMON",
+			a->arrivalTime, a->admissionTime, a->firstDispatchTime, a->exitTime,
+			a->cpuTicks, a->userTicks, a->readyTicks, a->blockedTicks,
+			a->numberOfDispatches, a->numberOfPreemptions, a->numberOfYields, a->numberOfSleeps,
+			Metrics_Turnaround(a), Metrics_Response(a), Metrics_Waiting(a));
+		first=0;
+	}
+	fprintf(reportFile, "\n  ],\n  \"system\": {\"totalTicks\": %lld, \"cpuUtilization\": %.4f, \"idleRatio\": %.4f, "
+		"\"contextSwitches\": %lld, \"contextSwitchesPer1000Ticks\": %.4f}\n}\n",
+		totalTicks, Metrics_Ratio(totalTicks-sipTicks-ticksWithoutProcess, totalTicks), Metrics_Ratio(sipTicks, totalTicks),
+		numberOfContextSwitches, 1000*Metrics_Ratio(numberOfContextSwitches, totalTicks));
+}
+
+// The same figures as the report, leaving the accounting as it is
+void Metrics_GetSummary(METRICS_SUMMARY *summary) {
+	PROCESS_ACCOUNTING accounting[PROGRAMSMAXNUMBER];
+	int live[PROGRAMSMAXNUMBER];
+	int i, PID, responses=0;
+	SIMTIME sipTicks=processTable[sipID].accounting.cpuTicks;
+
+	memset(summary, 0, sizeof(METRICS_SUMMARY));
+	memcpy(accounting, programAccounting, sizeof(accounting));
+	for (i=0; i<PROGRAMSMAXNUMBER; i++)
+		live[i]=processOfProgram[i]!=NOPROCESS;
+	for (PID=0; PID<PROCESSTABLEMAXSIZE; PID++)
+		if (processTable[PID].busy && processTable[PID].state!=EXIT) {
+			i=processTable[PID].programListIndex;
+			accounting[i]=processTable[PID].accounting;
+			Metrics_ChargeStateTime(&accounting[i], processTable[PID].state, Clock_GetTime());
+			live[i]=1;
+		}
+
+	summary->totalTicks=Clock_GetTime();
+	summary->cpuUtilization=Metrics_Ratio(summary->totalTicks-sipTicks-ticksWithoutProcess, summary->totalTicks);
+	summary->idleRatio=Metrics_Ratio(sipTicks, summary->totalTicks);
+	summary->contextSwitches=numberOfContextSwitches;
+	for (i=0; i<PROGRAMSMAXNUMBER; i++) {
+		if (!live[i])
+			continue;
+		summary->processes++;
+		summary->averageWaiting+=Metrics_Waiting(&accounting[i]);
+		if (Metrics_Turnaround(&accounting[i])!=METRICS_NOTHAPPENED) {
+			summary->terminatedProcesses++;
+			summary->averageTurnaround+=Metrics_Turnaround(&accounting[i]);
+		}
+		if (Metrics_Response(&accounting[i])!=METRICS_NOTHAPPENED) {
+			responses++;
+			summary->averageResponse+=Metrics_Response(&accounting[i]);
+		}
+	}
+	if (summary->processes>0)
+		summary->averageWaiting/=summary->processes;
+	if (summary->terminatedProcesses>0)
+		summary->averageTurnaround/=summary->terminatedProcesses;
+	if (responses>0)
+		summary->averageResponse/=responses;
+}
@@ -0,0 +1,52 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "Simulator.h"
+
+// Value of the accounting times of events that have not happened
+#define METRICS_NOTHAPPENED -1
+
+// Accounting of a process, kept into its PCB. Times are clock ticks
+typedef struct {
+	SIMTIME arrivalTime;
+	SIMTIME admissionTime;
+	SIMTIME firstDispatchTime;
+	SIMTIME exitTime;
+	SIMTIME cpuTicks;	// Ticks with the processor assigned, OS work on its behalf included
+	SIMTIME userTicks;	// Part of cpuTicks executed in user mode
+	SIMTIME readyTicks;
+	SIMTIME blockedTicks;
+	SIMTIME lastStateChange;
+	SIMTIME numberOfDispatches;
+	SIMTIME numberOfPreemptions;
+	SIMTIME numberOfYields;
+	SIMTIME numberOfSleeps;
+} PROCESS_ACCOUNTING;
+
+// System totals and averages over the processes, as in the report. Processes not
+// terminated yet count with their accounting up to now
+typedef struct {
+	SIMTIME totalTicks;
+	double cpuUtilization;
+	double idleRatio;
+	SIMTIME contextSwitches;
+	int processes;				// Programs that have become processes
+	int terminatedProcesses;
+	double averageTurnaround;	// Of the terminated processes
+	double averageResponse;		// Of the dispatched ones
+	double averageWaiting;
+} METRICS_SUMMARY;
+
+// Functions prototypes
+void Metrics_Initialize();
+void Metrics_ProcessCreated(int);
+void Metrics_ProcessStateChange(int, int);
+void Metrics_ChargeTick();
+void Metrics_WriteReport();
+void Metrics_GetSummary(METRICS_SUMMARY *);
+
+// File for the report written at power off (no report if empty) and its format: csv or json
+extern char *metricsFile;
+extern char *metricsFormat;
+
+#endif
@@ -4,6 +4,9 @@
 #include "Processor.h"
 #include "Buses.h"
 #include "Heap.h"
+#include "TimingWheel.h"
+#include "Clock.h"
+#include "FlightRecorder.h"
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
@@ -28,8 +31,13 @@ void OperatingSystem_PrintReadyToRunQueue();
 void OperatingSystem_HandleYield();
 void OperatingSystem_HandleClockInterrupt();
 void OperatingSystem_SendProcessToSleep();
-void OperatingSystem_WakeUpProcess();
+void OperatingSystem_WakeUpProcesses();
+void OperatingSystem_CheckPriorityPreemption();
+SIMTIME OperatingSystem_GetElapsedClockPeriods();
+void OperatingSystem_ProgramClockTimer();
+int OperatingSystem_AreThereUserProcessesToRun();
 int OperatingSystem_GetExecutingProcess();
+void OperatingSystem_ChangeProcessState(int, int);
 
 // The process table
 PCB processTable[PROCESSTABLEMAXSIZE];
@@ -61,11 +69,14 @@ char* queueNames[NUMBEROFQUEUES] = {"USER", "DAEMONS"};
 int numberOfNotTerminatedUserProcesses=0;
 
 // In OperatingSystem.c  Exercise 5-b of V2 
-// Heap with blocked processes sort by when to wakeup 
-heapItem sleepingProcessesQueue[PROCESSTABLEMAXSIZE]; 
+// Timing wheel with blocked processes sort by when to wakeup 
+TIMINGWHEEL sleepingProcessesQueue; 
 int numberOfSleepingProcesses=0;
 
-int interrupts = 1;
+SIMTIME numberOfClockInterrupts=0;
+
+// Tickless kernel: the clock only interrupts when the OS needs it
+int tickless=0;
 
 
 // Initial set of tasks of the OS
@@ -78,7 +89,8 @@ void OperatingSystem_Initialize(int daemonsIndex) {
 		// Show red message "FATAL ERROR: Missing Operating System!\n"
 		OperatingSystem_ShowTime(SHUTDOWN);
 		ComputerSystem_DebugMessage(99,SHUTDOWN,"FATAL ERROR: Missing Operating System!\n");
-		exit(1);		
+		FlightRecorder_Dump("FATAL ERROR: Missing Operating System");
+		Simulator_FatalError(1);
 	}
 
 	// Obtain the memory requirements of the program
@@ -91,6 +103,8 @@ void OperatingSystem_Initialize(int daemonsIndex) {
 	for (i=0; i<PROCESSTABLEMAXSIZE;i++){
 		processTable[i].busy=0;
 	}
+	TimingWheel_Initialize(&sleepingProcessesQueue, numberOfClockInterrupts);
+	Metrics_Initialize();
 	// Initialization of the interrupt vector table of the processor
 	Processor_InitializeInterruptVectorTable(OS_address_base+2);
 		
@@ -102,7 +116,7 @@ void OperatingSystem_Initialize(int daemonsIndex) {
 	OperatingSystem_PrintStatus();
 	OperatingSystem_LongTermScheduler();
 
-	if(numberOfNotTerminatedUserProcesses == 0)
+	if(!OperatingSystem_AreThereUserProcessesToRun())
 	{
 		Processor_ActivatePSW_Bit(POWEROFF_BIT);
 	}
@@ -111,7 +125,8 @@ void OperatingSystem_Initialize(int daemonsIndex) {
 		// Show red message "FATAL ERROR: Missing SIP program!\n"
 		OperatingSystem_ShowTime(SHUTDOWN);
 		ComputerSystem_DebugMessage(99,SHUTDOWN,"FATAL ERROR: Missing SIP program!\n");
-		exit(1);		
+		FlightRecorder_Dump("FATAL ERROR: Missing SIP program");
+		Simulator_FatalError(1);
 	}
 
 	// At least, one user process has been created
@@ -121,6 +136,12 @@ void OperatingSystem_Initialize(int daemonsIndex) {
 	// Assign the processor to the selected process
 	OperatingSystem_Dispatch(selectedProcess);
 
+	// Program the first clock interrupt
+	if (tickless) {
+		Clock_SetMode(CLOCK_ONESHOT);
+		OperatingSystem_ProgramClockTimer();
+	}
+
 	// Initial operation for Operating System
 	Processor_SetPC(OS_address_base);
 }
@@ -142,14 +163,16 @@ int OperatingSystem_PrepareStudentsDaemons(int programListDaemonsBase) {
 
 
 // The LTS is responsible of the admission of new processes in the system.
-// Initially, it creates a process from each program specified in the 
-// 			command line and daemons programs
+// It creates a process from each program specified in the command line
+// 			and daemons programs whose arrival time has come
 int OperatingSystem_LongTermScheduler() {
   
 	int PID, i,
 		numberOfSuccessfullyCreatedProcesses=0;
 	
-	for (i=0; programList[i]!=NULL && i<PROGRAMSMAXNUMBER ; i++) {
+	while (OperatingSystem_IsThereANewProgram()==YES) {
+		i=Heap_poll(arrivalTimeQueue, QUEUE_ARRIVAL, &numberOfProgramsInArrivalTimeQueue);
+		statusDirty|=STATUS_ARRIVAL;
 		PID = OperatingSystem_CreateProcess(i);
 
 		if(PID == NOFREEENTRY)
@@ -245,7 +268,7 @@ int OperatingSystem_CreateProcess(int indexOfExecutableProgram) {
 	
 	// Show message "Process [PID] created from program [executableName]\n"
 	OperatingSystem_ShowTime(INIT);
-	ComputerSystem_DebugMessage(70,INIT,PID,executableProgram->executableName);
+	ComputerSystem_ProcessDebugMessage(PID,70,INIT,PID,executableProgram->executableName);
 	
 	return PID;
 }
@@ -253,6 +276,8 @@ int OperatingSystem_CreateProcess(int indexOfExecutableProgram) {
 //Function to show processes ready to execute in the queue
 void OperatingSystem_PrintReadyToRunQueue()
 {
+	if (!ComputerSystem_IsDebugEnabled(SHORTTERMSCHEDULE))
+		return;
 	OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
 	ComputerSystem_DebugMessage(106, SHORTTERMSCHEDULE);
 	ComputerSystem_DebugMessage(107, SHORTTERMSCHEDULE);
@@ -302,20 +327,25 @@ int OperatingSystem_ObtainMainMemory(int processSize, int PID) {
 void OperatingSystem_PCBInitialization(int PID, int initialPhysicalAddress, int processSize, int priority, int processPLIndex) {
 
 	processTable[PID].busy=1;
+	statusDirty|=STATUS_PROCESSTABLE;
 	processTable[PID].initialPhysicalAddress=initialPhysicalAddress;
 	processTable[PID].processSize=processSize;
 	processTable[PID].state=NEW;
 	OperatingSystem_ShowTime(SYSPROC);
-	ComputerSystem_DebugMessage(111, SYSPROC, PID, programList[processPLIndex]->executableName, "NEW");
+	ComputerSystem_ProcessDebugMessage(PID, 111, SYSPROC, PID, programList[processPLIndex]->executableName, "NEW");
 	processTable[PID].priority=priority;
 	processTable[PID].programListIndex=processPLIndex;
+	processTable[PID].whenToWakeUp=0;
+	Metrics_ProcessCreated(PID);
 	// Daemons run in protected mode and MMU use real address
 	if (programList[processPLIndex]->type == DAEMONPROGRAM) {
+		processTable[PID].queueID=DAEMONSQUEUE;
 		processTable[PID].copyOfPCRegister=initialPhysicalAddress;
 		processTable[PID].copyOfPSWRegister= ((unsigned int) 1) << EXECUTION_MODE_BIT;
 		processTable[PID].copyOfAccRegister=0;
 	} 
 	else {
+		processTable[PID].queueID=USERPROCCESSQUEUE;
 		processTable[PID].copyOfPCRegister=0;
 		processTable[PID].copyOfPSWRegister=0;
 		processTable[PID].copyOfAccRegister=0;
@@ -329,22 +359,23 @@ void OperatingSystem_PCBInitialization(int PID, int initialPhysicalAddress, int
 void OperatingSystem_MoveToTheREADYState(int PID, int typeQueue) {
 	
 	if (Heap_add(PID, readyToRunQueues[typeQueue] ,typeQueue ,&numberOfReadyToRunProcesses[typeQueue] ,PROCESSTABLEMAXSIZE)>=0) {
+		statusDirty|=STATUS_READY;
 		switch (processTable[PID].state)
 		{
 			case NEW:
 				OperatingSystem_ShowTime(SYSPROC);
-				ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "NEW", "READY");
+				ComputerSystem_ProcessDebugMessage(PID, 110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "NEW", "READY");
 				break;
 			case EXECUTING:
 				OperatingSystem_ShowTime(SYSPROC);
-				ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "EXECUTING", "READY");
+				ComputerSystem_ProcessDebugMessage(PID, 110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "EXECUTING", "READY");
+				break;
+			case BLOCKED:
+				OperatingSystem_ShowTime(SYSPROC);
+				ComputerSystem_ProcessDebugMessage(PID, 110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "BLOCKED", "READY");
 				break;
-			// case BLOCKED:
-			// 	OperatingSystem_ShowTime(SYSPROC);
-			// 	ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "BLOCKED", "READY");
-			// 	break;
 		}
-		processTable[PID].state=READY;
+		OperatingSystem_ChangeProcessState(PID, READY);
 	}
 	//OperatingSystem_PrintReadyToRunQueue();
 }
@@ -357,10 +388,10 @@ int OperatingSystem_ShortTermScheduler() {
 	
 	int selectedProcess;
 
-	if(numberOfNotTerminatedUserProcesses > 0)
-		selectedProcess=OperatingSystem_ExtractFromReadyToRun(USERPROCCESSQUEUE);
-	else
-		selectedProcess=OperatingSystem_ExtractFromReadyToRun(DAEMONPROGRAM);
+	// User processes go first; daemons run when all of them have finished or are sleeping
+	selectedProcess=OperatingSystem_ExtractFromReadyToRun(USERPROCCESSQUEUE);
+	if (selectedProcess==NOPROCESS)
+		selectedProcess=OperatingSystem_ExtractFromReadyToRun(DAEMONSQUEUE);
 	
 	return selectedProcess;
 }
@@ -371,6 +402,8 @@ int OperatingSystem_ExtractFromReadyToRun(int typeQueue) {
   
 	int selectedProcess=NOPROCESS;
 	selectedProcess=Heap_poll(readyToRunQueues[typeQueue] ,typeQueue ,&numberOfReadyToRunProcesses[typeQueue]);
+	if (selectedProcess!=NOPROCESS)
+		statusDirty|=STATUS_READY;
 	// Return most priority process or NOPROCESS if empty queue
 	return selectedProcess; 
 }
@@ -381,12 +414,14 @@ void OperatingSystem_Dispatch(int PID) {
 
 	// The process identified by PID becomes the current executing process
 	executingProcessID=PID;
+	FlightRecorder_Record(FLIGHT_DISPATCH, PID, 0, 0);
+	statusDirty|=STATUS_EXECUTING;
 	// Change the process' state
-	processTable[PID].state=EXECUTING;
+	OperatingSystem_ChangeProcessState(PID, EXECUTING);
 	// Modify hardware registers with appropriate values for the process identified by PID
 	OperatingSystem_RestoreContext(PID);
 	OperatingSystem_ShowTime(SYSPROC);
-	ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "READY", "EXECUTING");
+	ComputerSystem_ProcessDebugMessage(PID, 110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "READY", "EXECUTING");
 }
 
 
@@ -408,16 +443,10 @@ void OperatingSystem_PreemptRunningProcess() {
 	// Save in the process' PCB essential values stored in hardware registers and the system stack
 	OperatingSystem_SaveContext(executingProcessID);
 	// Change the process' state
-	if(numberOfNotTerminatedUserProcesses == 0 || executingProcessID == PROCESSTABLEMAXSIZE - 1)
-	{
-		OperatingSystem_MoveToTheREADYState(executingProcessID, DAEMONSQUEUE);	
-	}
-	else
-	{
-		OperatingSystem_MoveToTheREADYState(executingProcessID, USERPROCCESSQUEUE);
-	}
+	OperatingSystem_MoveToTheREADYState(executingProcessID, processTable[executingProcessID].queueID);
 	// The processor is not assigned until the OS selects another process
 	executingProcessID=NOPROCESS;
+	statusDirty|=STATUS_EXECUTING;
 }
 
 
@@ -439,6 +468,7 @@ void OperatingSystem_HandleException() {
 	// Show message "Process [executingProcessID] has generated an exception and is terminating\n"
 	OperatingSystem_ShowTime(SYSPROC);
 	ComputerSystem_DebugMessage(71,SYSPROC,executingProcessID,programList[processTable[executingProcessID].programListIndex]->executableName);
+	FlightRecorder_Dump("Exception");
 	
 	OperatingSystem_TerminateProcess();
 }
@@ -449,13 +479,13 @@ void OperatingSystem_TerminateProcess() {
   
 	int selectedProcess;
   	
-	processTable[executingProcessID].state=EXIT;
+	OperatingSystem_ChangeProcessState(executingProcessID, EXIT);
 	
 	if (programList[processTable[executingProcessID].programListIndex]->type==USERPROGRAM) 
 		// One more user process that has terminated
 		numberOfNotTerminatedUserProcesses--;
 	
-	if (numberOfNotTerminatedUserProcesses==0) {
+	if (!OperatingSystem_AreThereUserProcessesToRun()) {
 		if (executingProcessID==sipID) {
 			// finishing sipID, change PC to address of OS HALT instruction
 			OperatingSystem_TerminatingSIP();
@@ -514,6 +544,7 @@ void OperatingSystem_HandleYield()
 			OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
 			ComputerSystem_DebugMessage(115, SHORTTERMSCHEDULE, executingProcessID, programList[executingProcessID + 1]->executableName, 
 			PID_OF_NEXT, programList[PID_OF_NEXT + 1]->executableName);
+			processTable[executingProcessID].accounting.numberOfYields++;
 			nextProcess = OperatingSystem_ShortTermScheduler();
 			OperatingSystem_PreemptRunningProcess();
 			OperatingSystem_Dispatch(nextProcess);
@@ -529,6 +560,7 @@ void OperatingSystem_HandleYield()
 			OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
 			ComputerSystem_DebugMessage(115, SHORTTERMSCHEDULE, executingProcessID, programList[executingProcessID + 1]->executableName, 
 			PID_OF_NEXT, programList[PID_OF_NEXT + 1]->executableName);
+			processTable[executingProcessID].accounting.numberOfYields++;
 			nextProcess = OperatingSystem_ShortTermScheduler();
 			OperatingSystem_PreemptRunningProcess();
 			OperatingSystem_Dispatch(nextProcess);
@@ -554,49 +586,130 @@ void OperatingSystem_InterruptLogic(int entryPoint)
 			OperatingSystem_PrintStatus();
 			break;
 	}
+	// The handled event may have changed which is the next one needing a clock interrupt
+	if (tickless)
+		OperatingSystem_ProgramClockTimer();
 
 }
 // In OperatingSystem.c Exercise 2-b of V2
 void OperatingSystem_HandleClockInterrupt()
 { 
-	if(interrupts == 1){
-		Heap_poll(sleepingProcessesQueue, QUEUE_WAKEUP, &numberOfSleepingProcesses);
-	}
+	int numberOfCreatedProcesses;
+
+	// Without periodic interrupts, the clock periods elapsed are obtained from the clock
+	numberOfClockInterrupts=tickless?OperatingSystem_GetElapsedClockPeriods():numberOfClockInterrupts+1;
 	OperatingSystem_ShowTime(INTERRUPT);
-	ComputerSystem_DebugMessage(120, INTERRUPT, interrupts++);
-	OperatingSystem_WakeUpProcess();
-	return;
+	ComputerSystem_DebugMessage(120, INTERRUPT, numberOfClockInterrupts);
+	OperatingSystem_WakeUpProcesses();
+
+	// Programs whose arrival time has come are admitted
+	numberOfCreatedProcesses=OperatingSystem_LongTermScheduler();
+	if (numberOfCreatedProcesses>0)
+		OperatingSystem_CheckPriorityPreemption();
+	else if (!OperatingSystem_AreThereUserProcessesToRun())
+		OperatingSystem_ReadyToShutdown();
 }
 
-void OperatingSystem_WakeUpProcess()
+// Every sleeping process whose wake up time has passed goes back to the READY state
+// as one batch, and then the processor is given to the most priority process
+void OperatingSystem_WakeUpProcesses()
 {
-	if(Heap_getFirst(sleepingProcessesQueue, numberOfSleepingProcesses) != -1
-		&& processTable[Heap_getFirst(sleepingProcessesQueue, numberOfSleepingProcesses)].whenToWakeUp == interrupts)
-	{
-		int sleepingPID = Heap_poll(sleepingProcessesQueue, QUEUE_WAKEUP, &numberOfSleepingProcesses);
-		Heap_add(sleepingPID,readyToRunQueues[USERPROCCESSQUEUE], QUEUE_PRIORITY, &numberOfNotTerminatedUserProcesses, PROCESSTABLEMAXSIZE);
-		numberOfNotTerminatedUserProcesses++;
-		int nextPid = OperatingSystem_ShortTermScheduler();
+	int wokenUpProcesses[PROCESSTABLEMAXSIZE];
+	int i, numberOfWokenUpProcesses;
+
+	numberOfWokenUpProcesses=TimingWheel_Advance(&sleepingProcessesQueue, numberOfClockInterrupts, wokenUpProcesses);
+	if (numberOfWokenUpProcesses>0)
+		statusDirty|=STATUS_SLEEPING;
+	for (i=0; i<numberOfWokenUpProcesses; i++) {
+		numberOfSleepingProcesses--;
+		OperatingSystem_MoveToTheREADYState(wokenUpProcesses[i], processTable[wokenUpProcesses[i]].queueID);
+	}
+	if (numberOfWokenUpProcesses>0)
+		OperatingSystem_CheckPriorityPreemption();
+}
+
+// The executing process leaves the processor if there is a READY process with more priority
+void OperatingSystem_CheckPriorityPreemption()
+{
+	int queue=USERPROCCESSQUEUE;
+	int candidatePID;
+
+	if (numberOfReadyToRunProcesses[USERPROCCESSQUEUE]==0)
+		queue=DAEMONSQUEUE;
+	candidatePID=Heap_getFirst(readyToRunQueues[queue], numberOfReadyToRunProcesses[queue]);
+	if (candidatePID==NOPROCESS)
+		return;
+	if (executingProcessID!=NOPROCESS
+		&& (processTable[executingProcessID].queueID<queue
+			|| (processTable[executingProcessID].queueID==queue
+				&& processTable[executingProcessID].priority<=processTable[candidatePID].priority)))
+		return;
+	if (executingProcessID!=NOPROCESS) {
+		processTable[executingProcessID].accounting.numberOfPreemptions++;
 		OperatingSystem_PreemptRunningProcess();
-		OperatingSystem_Dispatch(nextPid);
 	}
+	OperatingSystem_Dispatch(OperatingSystem_ShortTermScheduler());
 }
 
+// The executing process is blocked until abs(accumulator)+1 clock interrupts have occurred
 void OperatingSystem_SendProcessToSleep()
 {
 	int PID = executingProcessID;
+
 	OperatingSystem_SaveContext(PID);
-	processTable[PID].whenToWakeUp = interrupts + abs(Processor_GetRegisterA()) + 1;
-	//ComputerSystem_DebugMessage(110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "EXECUTING", "BLOCKED");
-	OperatingSystem_PreemptRunningProcess();
-	processTable[PID].state = BLOCKED;
-	Heap_add(processTable[PID].whenToWakeUp, sleepingProcessesQueue, QUEUE_WAKEUP, &numberOfSleepingProcesses, PROCESSTABLEMAXSIZE);
-	Heap_poll(readyToRunQueues[USERPROCCESSQUEUE], QUEUE_PRIORITY, &numberOfNotTerminatedUserProcesses);
+	processTable[PID].whenToWakeUp = OperatingSystem_GetElapsedClockPeriods() + llabs((SIMTIME) Processor_GetAccumulator()) + 1;
+	if (TimingWheel_Insert(&sleepingProcessesQueue, PID, processTable[PID].whenToWakeUp)<0)
+		return;
 	numberOfSleepingProcesses++;
-	OperatingSystem_Dispatch(PID);
+	statusDirty|=STATUS_SLEEPING;
+	OperatingSystem_ShowTime(SYSPROC);
+	ComputerSystem_ProcessDebugMessage(PID, 110, SYSPROC, PID, programList[processTable[PID].programListIndex]->executableName, "EXECUTING", "BLOCKED");
+	processTable[PID].accounting.numberOfSleeps++;
+	OperatingSystem_ChangeProcessState(PID, BLOCKED);
+	executingProcessID=NOPROCESS;
+	statusDirty|=STATUS_EXECUTING;
+	OperatingSystem_Dispatch(OperatingSystem_ShortTermScheduler());
 }
 
 int OperatingSystem_GetExecutingProcess()
 {
 	return executingProcessID;
+}
+
+// Every state transition goes through here, so the process accounting is kept up to date
+void OperatingSystem_ChangeProcessState(int PID, int newState)
+{
+	Metrics_ProcessStateChange(PID, newState);
+	FlightRecorder_Record(FLIGHT_STATE, PID, processTable[PID].state, newState);
+	processTable[PID].state=newState;
+}
+
+// Sleeping times are measured in clock periods. With periodic interrupts each one is
+// a period, in a tickless kernel they are obtained from the current time
+SIMTIME OperatingSystem_GetElapsedClockPeriods()
+{
+	if (tickless)
+		return Clock_GetTime() / Clock_GetPeriod();
+	return numberOfClockInterrupts;
+}
+
+// Tickless kernel: the one-shot timer is armed for the earliest wake up, program
+// arrivals raise their own interrupt. While nothing is due (idle CPU or runnable
+// processes without sleeping ones) no interrupt is raised.
+// There is no quantum in this OS, so executing processes never need a periodic tick
+void OperatingSystem_ProgramClockTimer()
+{
+	SIMTIME nextWakeUp=TimingWheel_GetFirstDeadline(&sleepingProcessesQueue);
+
+	if (nextWakeUp>=0)
+		Clock_SetTimer(nextWakeUp*Clock_GetPeriod());
+	else
+		Clock_SetTimer(-1);
+}
+
+// The simulation goes on while there are user processes not terminated or
+// user programs still to arrive
+int OperatingSystem_AreThereUserProcessesToRun()
+{
+	return numberOfNotTerminatedUserProcesses>0 || OperatingSystem_IsThereANewProgram()!=EMPTYQUEUE;
 }
\ No newline at end of file
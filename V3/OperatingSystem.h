@@ -2,6 +2,7 @@
 #define OPERATINGSYSTEM_H
 
 #include "ComputerSystem.h"
+#include "Metrics.h"
 #include <stdio.h>
 
 
@@ -45,7 +46,8 @@ typedef struct {
 	unsigned int copyOfPSWRegister;
 	int copyOfAccRegister;
 	int programListIndex;
-	int whenToWakeUp;
+	SIMTIME whenToWakeUp;
+	PROCESS_ACCOUNTING accounting;
 } PCB;
 
 // These "extern" declaration enables other source code files to gain access
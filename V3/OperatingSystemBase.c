@@ -21,6 +21,14 @@ extern int initialPID;
 extern int baseDaemonsInProgramList;
 
 extern int executingProcessID;
+
+// Status reports. Everything is shown in the first one
+int statusDirty=STATUS_ALL;
+char defaultStatusMode[]="full";
+char *statusMode=defaultStatusMode;
+int statusSnapshot=0;
+int statusReportsSinceSnapshot=0;
+
 #ifdef SLEEPINGQUEUE
 	extern char * queueNames []; 
 #endif
@@ -44,11 +52,12 @@ int OperatingSystem_ObtainAnEntryInTheProcessTable() {
 				for (i=0;i<PROCESSTABLEMAXSIZE;i++)
 					if (processTable[i].busy && (processTable[i].state==EXIT)) {
 						OperatingSystem_ShowTime(SYSPROC);
-						ComputerSystem_DebugMessage(79,SYSPROC
+						ComputerSystem_ProcessDebugMessage(i,79,SYSPROC
 							,i,programList[processTable[i].programListIndex]->executableName
 							,processTable[i].processSize
 							,processTable[i].initialPhysicalAddress);
 						processTable[i].busy=0;
+						statusDirty|=STATUS_PROCESSTABLE;
 						index=0; // New search after liberation of PCB
 					}
 			}
@@ -196,7 +205,7 @@ int OperatingSystem_PrepareTeachersDaemons(int programListDaemonsBase){
 	char lineRead[MAXLINELENGTH];
 	PROGRAMS_DATA *progData;
 	char *name, *arrivalTime;
-	int time;
+	SIMTIME time;
 
 
 	daemonsFile= fopen("teachersDaemons", "r");
@@ -214,7 +223,7 @@ int OperatingSystem_PrepareTeachersDaemons(int programListDaemonsBase){
 
 		arrivalTime=strtok(NULL,",");
     	if (arrivalTime==NULL
-    		|| sscanf(arrivalTime,"%d",&time)==0)
+    		|| sscanf(arrivalTime,"%lld",&time)==0)
     		time=0;
     	
     	progData=(PROGRAMS_DATA *) malloc(sizeof(PROGRAMS_DATA));
@@ -244,27 +253,44 @@ void OperatingSystem_TerminatingSIP() {
 	processTable[sipID].copyOfPSWRegister|= ((unsigned int) 1) << INTERRUPT_MASKED_BIT;
 	Processor_CopyInSystemStack(MAINMEMORYSIZE-2,processTable[sipID].copyOfPSWRegister);
 	executingProcessID=NOPROCESS;
+	statusDirty|=STATUS_EXECUTING;
 }
 
 // Show time messages
 void OperatingSystem_ShowTime(char section) {
-	ComputerSystem_DebugMessage(100,section,Processor_PSW_BitState(EXECUTION_MODE_BIT)?"\t":"");
-	ComputerSystem_DebugMessage(Processor_PSW_BitState(EXECUTION_MODE_BIT)?95:94,section,Clock_GetTime());
+	if (!ComputerSystem_IsDebugEnabled(section))
+		return;
+	ComputerSystem_TimeStamp(section, 1);
 }
 
-// Show general status
+// Show general status. In delta mode only the structures changed since the last
+// report are shown, with a full report every statusSnapshot reports (never if 0)
 void OperatingSystem_PrintStatus(){ 
-	OperatingSystem_PrintExecutingProcessInformation(); // Show executing process information
-	OperatingSystem_PrintReadyToRunQueue();  // Show Ready to run queues implemented for students
-	OperatingSystem_PrintSleepingProcessQueue(); // Show Sleeping process queue
-	OperatingSystem_PrintProcessTableAssociation(); // Show PID-Program's name association
-	ComputerSystem_PrintArrivalTimeQueue(); // Show arrival queue of programs
+	if (strcmp(statusMode,"delta")!=0)
+		statusDirty=STATUS_ALL;
+	else if (statusSnapshot>0 && ++statusReportsSinceSnapshot>=statusSnapshot) {
+		statusDirty=STATUS_ALL;
+		statusReportsSinceSnapshot=0;
+	}
+	if (statusDirty & STATUS_EXECUTING)
+		OperatingSystem_PrintExecutingProcessInformation(); // Show executing process information
+	if (statusDirty & STATUS_READY)
+		OperatingSystem_PrintReadyToRunQueue();  // Show Ready to run queues implemented for students
+	if (statusDirty & STATUS_SLEEPING)
+		OperatingSystem_PrintSleepingProcessQueue(); // Show Sleeping process queue
+	if (statusDirty & STATUS_PROCESSTABLE)
+		OperatingSystem_PrintProcessTableAssociation(); // Show PID-Program's name association
+	if (statusDirty & STATUS_ARRIVAL)
+		ComputerSystem_PrintArrivalTimeQueue(); // Show arrival queue of programs
+	statusDirty=0;
 }
 
  // Show Executing process information
 void OperatingSystem_PrintExecutingProcessInformation(){ 
 #ifdef SLEEPINGQUEUE
 
+	if (!ComputerSystem_IsDebugEnabled(SHORTTERMSCHEDULE))
+		return;
 	OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
 	if (executingProcessID>=0)
 		// Show message "Running Process Information:\n\t\t[PID: executingProcessID, Priority: priority, WakeUp: whenToWakeUp, Queue: queueID]\n"
@@ -282,16 +308,22 @@ void OperatingSystem_PrintSleepingProcessQueue(){
 #ifdef SLEEPINGQUEUE
 
 	int i;
+	int sleepingPIDs[TIMINGWHEELMAXITEMS];
+
+	if (!ComputerSystem_IsDebugEnabled(SHORTTERMSCHEDULE))
+		return;
 	OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
 	//  Show message "SLEEPING Queue:\n\t\t");
 	ComputerSystem_DebugMessage(100,SHORTTERMSCHEDULE,"SLEEPING Queue:\n\t\t");
+	// Sleeping processes sorted by when to wakeup
+	TimingWheel_GetItems(&sleepingProcessesQueue, sleepingPIDs);
 	if (numberOfSleepingProcesses>0)
 		for (i=0; i< numberOfSleepingProcesses; i++) {
 			// Show message [PID, priority, whenToWakeUp]
 			ComputerSystem_DebugMessage(75,SHORTTERMSCHEDULE
-				, sleepingProcessesQueue[i].info
-				, processTable[sleepingProcessesQueue[i].info].priority
-				, processTable[sleepingProcessesQueue[i].info].whenToWakeUp);
+				, sleepingPIDs[i]
+				, processTable[sleepingPIDs[i]].priority
+				, processTable[sleepingPIDs[i]].whenToWakeUp);
 			if (i<numberOfSleepingProcesses-1)
 	  			ComputerSystem_DebugMessage(100,SHORTTERMSCHEDULE,", ");
   		}
@@ -304,6 +336,8 @@ void OperatingSystem_PrintSleepingProcessQueue(){
 
 void OperatingSystem_PrintProcessTableAssociation() {
   int i;
+  if (!ComputerSystem_IsDebugEnabled(SHORTTERMSCHEDULE))
+	return;
   OperatingSystem_ShowTime(SHORTTERMSCHEDULE);
   //  Show message "Process table association with program's name:");
   ComputerSystem_DebugMessage(100,SHORTTERMSCHEDULE,"PID association with program's name:\n");
@@ -322,8 +356,8 @@ void OperatingSystem_PrintProcessTableAssociation() {
 // considered by the LTS to create processes at the current time
 int OperatingSystem_IsThereANewProgram() {
 #ifdef ARRIVALQUEUE
-        int currentTime;
-		int programArrivalTime;
+        SIMTIME currentTime;
+		SIMTIME programArrivalTime;
 		int indexInProgramList = Heap_getFirst(arrivalTimeQueue,numberOfProgramsInArrivalTimeQueue);
 
 		if (indexInProgramList < 0)
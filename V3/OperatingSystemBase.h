@@ -4,6 +4,7 @@
 #include "ComputerSystem.h"
 #include "OperatingSystem.h"
 #include "Heap.h"
+#include "TimingWheel.h"
 #include <stdio.h>
 
 // Prototypes of OS functions that students should not change
@@ -20,12 +21,28 @@ void OperatingSystem_PrintStatus();
 void OperatingSystem_PrintReadyToRunQueue();
 int OperatingSystem_IsThereANewProgram();
 
+// Structures shown by OperatingSystem_PrintStatus, as bits of statusDirty
+#define STATUS_EXECUTING 1
+#define STATUS_READY 2
+#define STATUS_SLEEPING 4
+#define STATUS_PROCESSTABLE 8
+#define STATUS_ARRIVAL 16
+#define STATUS_ALL 31
+
+// Structures changed since the last status report
+extern int statusDirty;
+
+// Status reports: "full" or "delta" (only the changed structures), and reports
+// between full ones in delta mode
+extern char *statusMode;
+extern int statusSnapshot;
+
 #define EMPTYQUEUE -1
 #define NO 0
 #define YES 1
 
 #ifdef SLEEPINGQUEUE
-extern heapItem sleepingProcessesQueue[];
+extern TIMINGWHEEL sleepingProcessesQueue;
 extern int numberOfSleepingProcesses; 
 #endif
 
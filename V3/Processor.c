@@ -7,6 +7,8 @@
 #include <string.h>
 #include "Wrappers.h"
 #include "MMU.h"
+#include "FlightRecorder.h"
+#include "Machine.h"
 
 // Internals Functions prototypes
 void Processor_ManageInterrupts();
@@ -33,6 +35,9 @@ int interruptVectorTable[INTERRUPTTYPES];
 // For PSW show "--------X---FNZS"
 char pswmask []="----------------"; 
 
+// Reads without bus transfers (see Buses_FastRead_CPU)
+int fastEngine=0;
+
 // Initialization of the interrupt vector table
 void Processor_InitializeInterruptVectorTable(int interruptVectorInitialAddress) {
 	int i;
@@ -45,32 +50,53 @@ void Processor_InitializeInterruptVectorTable(int interruptVectorInitialAddress)
 	interruptVectorTable[EXCEPTION_BIT]=interruptVectorInitialAddress+2; // EXCEPTION_BIT=6
 }
 
+// Read of the logical address in MAR into MBR, through the MMU
+void Processor_BusRead() {
+	// Send to the MMU the address in which the reading has to take place: use the address bus for this
+	Buses_write_AddressBus_From_To(CPU, MMU);
+	// Tell the MMU controller to read
+	registerCTRL_CPU=CTRLREAD;
+	Buses_write_ControlBus_From_To(CPU,MMU);
+}
+
+// The reads go through the buses, the reference engine, or the fast path, or both of
+// them compared with --lockstep
+void Processor_ReadMemory() {
+	if (lockstep)
+		Machine_LockstepRead();
+	else if (fastEngine)
+		Buses_FastRead_CPU();
+	else
+		Processor_BusRead();
+}
+
 // Fetch an instruction from main memory and put it in the IR register
 int Processor_FetchInstruction() {
 
 	// The instruction must be located at the logical memory address pointed by the PC register
 	registerMAR_CPU=registerPC_CPU;
-	// Send to the MMU the address in which the reading has to take place: use the address bus for this
-	Buses_write_AddressBus_From_To(CPU, MMU);
-	// Tell the main memory controller to read
-	registerCTRL_CPU=CTRLREAD;
-	Buses_write_ControlBus_From_To(CPU,MMU);
+	Processor_ReadMemory();
 
 	if (registerCTRL_CPU & CTRL_SUCCESS) {
 		// All the read data is stored in the MBR register. Because it is an instruction
 		// we have to copy it to the IR register
 		memcpy((void *) (&registerIR_CPU), (void *) (&registerMBR_CPU), sizeof(BUSDATACELL));
+		FlightRecorder_Record(FLIGHT_FETCH, registerPC_CPU, registerIR_CPU.cell, 0);
 		// Show initial part of HARDWARE message with Operation Code and operands
 		// Show message: operationCode operand1 operand2
-		char codedInstruction[13]; // Coded instruction with separated fields to show
-		Processor_GetCodedInstruction(codedInstruction,registerIR_CPU);
-		ComputerSystem_ShowTime(HARDWARE);
-		ComputerSystem_DebugMessage(68, HARDWARE, codedInstruction);
+		if (ComputerSystem_IsDebugEnabled(HARDWARE)) {
+			char codedInstruction[13]; // Coded instruction with separated fields to show
+			Processor_GetCodedInstruction(codedInstruction,registerIR_CPU);
+			ComputerSystem_ShowTime(HARDWARE);
+			ComputerSystem_DebugMessage(68, HARDWARE, codedInstruction);
+		}
 	}
 	else {
 		// Show message: "_ _ _ "
-		ComputerSystem_ShowTime(HARDWARE);
-		ComputerSystem_DebugMessage(100,HARDWARE,"_ _ _\n");
+		if (ComputerSystem_IsDebugEnabled(HARDWARE)) {
+			ComputerSystem_ShowTime(HARDWARE);
+			ComputerSystem_DebugMessage(100,HARDWARE,"_ _ _\n");
+		}
 		return CPU_FAIL;
 	}
 	return CPU_SUCCESS;
@@ -104,10 +130,7 @@ void Processor_DecodeAndExecuteInstruction() {
 			//Set the value of the memAddres to the MAR
 			registerMAR_CPU = operand2;
 			//Search in the direction
-			Buses_write_AddressBus_From_To(CPU, MMU);
-			// Tell the MMU controller to read
-			registerCTRL_CPU=CTRLREAD;
-			Buses_write_ControlBus_From_To(CPU,MMU);
+			Processor_ReadMemory();
 			//then we write the obtained data to the cpuMBR register
 			Buses_write_DataBus_From_To(MMU, CPU);
 			//The data is stored in the MBR Register of the processor
@@ -184,11 +207,7 @@ void Processor_DecodeAndExecuteInstruction() {
 		// Instruction READ
 		case READ_INST: 
 			registerMAR_CPU=operand1;
-			// Send to the MMU controller the address in which the reading has to take place: use the address bus for this
-			Buses_write_AddressBus_From_To(CPU, MMU);
-			// Tell the MMU controller to read
-			registerCTRL_CPU=CTRLREAD;
-			Buses_write_ControlBus_From_To(CPU,MMU);
+			Processor_ReadMemory();
 
 			// Copy the read data to the accumulator register
 			registerAccumulator_CPU= registerMBR_CPU.cell;
@@ -212,8 +231,9 @@ void Processor_DecodeAndExecuteInstruction() {
 		case OS_INST: // Make a operating system routine in entry point indicated by operand1
 			// Show final part of HARDWARE message with CPU registers
 			// Show message: " (PC: registerPC_CPU, Accumulator: registerAccumulator_CPU, PSW: registerPSW_CPU [Processor_ShowPSW()]\n
-			ComputerSystem_DebugMessage(130, HARDWARE, InstructionNames[operationCode],operand1,operand2, PIDShownForOSInstruction,
-				registerPC_CPU,registerAccumulator_CPU,registerPSW_CPU,Processor_ShowPSW());
+			if (ComputerSystem_IsDebugEnabled(HARDWARE))
+				ComputerSystem_DebugMessage(130, HARDWARE, InstructionNames[operationCode],operand1,operand2, PIDShownForOSInstruction,
+					registerPC_CPU,registerAccumulator_CPU,registerPSW_CPU,Processor_ShowPSW());
 			// Not all operating system code is executed in simulated processor, but really must do it... 
 			OperatingSystem_InterruptLogic(operand1);
 			registerPC_CPU++;
@@ -239,8 +259,9 @@ void Processor_DecodeAndExecuteInstruction() {
 	
 	// Show final part of HARDWARE message with	CPU registers
 	// Show message: " (PC: registerPC_CPU, Accumulator: registerAccumulator_CPU, PSW: registerPSW_CPU [Processor_ShowPSW()]\n
-	ComputerSystem_DebugMessage(130, HARDWARE, InstructionNames[operationCode],operand1,operand2, OperatingSystem_GetExecutingProcess(),
-		 registerPC_CPU,registerAccumulator_CPU,registerPSW_CPU,Processor_ShowPSW());
+	if (ComputerSystem_IsDebugEnabled(HARDWARE))
+		ComputerSystem_DebugMessage(130, HARDWARE, InstructionNames[operationCode],operand1,operand2, OperatingSystem_GetExecutingProcess(),
+			 registerPC_CPU,registerAccumulator_CPU,registerPSW_CPU,Processor_ShowPSW());
 }
 	
 	
@@ -19,6 +19,8 @@ enum INT_BITS {SYSCALL_BIT=2, EXCEPTION_BIT=6, CLOCKINT_BIT=9};
 // Functions prototypes
 void Processor_InitializeInterruptVectorTable();
 int Processor_FetchInstruction();
+void Processor_BusRead();
+void Processor_ReadMemory();
 void Processor_InstructionCycleLoop();
 void Processor_DecodeAndExecuteInstruction();
 void Processor_RaiseInterrupt(const unsigned int);
@@ -28,4 +30,7 @@ char * Processor_ShowPSW();
 int Processor_GetCTRL();
 void Processor_SetCTRL(int);
 
+// Reads without bus transfers
+extern int fastEngine;
+
 #endif
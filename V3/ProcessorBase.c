@@ -6,6 +6,8 @@
 #include "Buses.h"
 #include "Clock.h"
 #include "Asserts.h"
+#include "FlightRecorder.h"
+#include "Wrappers.h"
 
 extern int registerPC_CPU; // Program counter
 extern int registerAccumulator_CPU; // Accumulator
@@ -20,13 +22,6 @@ extern int interruptLines_CPU; // Processor interrupt lines
 extern int interruptVectorTable[];
 extern char pswmask []; 
 
-char *InstructionNames[] = {
-"NONEXISTING_INSTRUCTION",
-#define INST(name) #name, // #name cast parameter name to String
-#include "Instructions.def"
-#undef INST
-};
-
 
 // This is the instruction cycle loop (fetch, decoding, execution, etc.).
 // The processor stops working when an POWEROFF signal is stored in its
@@ -34,7 +29,9 @@ char *InstructionNames[] = {
 void Processor_InstructionCycleLoop() {
 
 	while (!Processor_PSW_BitState(POWEROFF_BIT)) {
-		if (Processor_FetchInstruction()==CPU_SUCCESS){
+		// The instructions before the next event go at once, the one meeting it
+		// through the checks of every instruction
+		if (Wrappers_RunUntilNextEvent()==0 && Processor_FetchInstruction()==CPU_SUCCESS){
 			Processor_DecodeAndExecuteInstruction();
 		}
 		if (interruptLines_CPU){
@@ -101,6 +98,7 @@ void Processor_RaiseInterrupt(const unsigned int interruptNumber) {
 
 	mask = mask << interruptNumber;
 	interruptLines_CPU = interruptLines_CPU | mask;
+	FlightRecorder_Record(FLIGHT_RAISE, interruptNumber, 0, 0);
 }
 
 // Put the specified interrupt line to a low level 
@@ -111,6 +109,7 @@ void Processor_ACKInterrupt(const unsigned int interruptNumber) {
 	mask = ~mask;
 
 	interruptLines_CPU = interruptLines_CPU & mask;
+	FlightRecorder_Record(FLIGHT_ACK, interruptNumber, 0, 0);
 }
 
 // Returns the state of a given interrupt line (1=high level, 0=low level)
@@ -241,12 +240,4 @@ int Processor_DecodeOperand2(BUSDATACELL memCell) {
 
 void Processor_GetCodedInstruction(char * result, BUSDATACELL memCell){
 	sprintf(result,"%02X %03X %03X",((registerIR_CPU.cell>>24)&0xff),((registerIR_CPU.cell>>12)&0xfff),(registerIR_CPU.cell&0xfff));	
-}
-
-int Processor_ToInstruction(char * operation) {
-	int i;
-	for (i=0;i<LAST_INST;i++)
-		if (strcasecmp(InstructionNames[i],operation)==0)
-			return i;
-	return NONEXISTING_INST;
 }
\ No newline at end of file
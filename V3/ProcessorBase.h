@@ -59,4 +59,7 @@ int Processor_DecodeOperand2(BUSDATACELL);
 void Processor_GetCodedInstruction(char * , BUSDATACELL );
 int Processor_ToInstruction(char *); 
 
+// Names of the instructions, indexed by their codes (see Instructions.c)
+extern char *InstructionNames[];
+
 #endif
@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "ResultCache.h"
+#include "CheckpointCache.h"
+#include "Checkpoint.h"
+#include "ComputerSystem.h"
+#include "OperatingSystemBase.h"
+#include "Asserts.h"
+#include "Metrics.h"
+#include "Log.h"
+#include "GoldenState.h"
+#include "StateHash.h"
+#include "FlightRecorder.h"
+
+// Internal Functions prototypes
+int ResultCache_Cacheable();
+unsigned long long ResultCache_HashDaemons(unsigned long long);
+int ResultCache_Replay(char *);
+int ResultCache_Record(char *);
+int ResultCache_FlightRecorderTime(struct timespec *);
+
+char *resultCache="";
+
+// Hash of the arguments, taken before the options are split
+unsigned long long resultCacheHash=CHECKPOINTCACHE_FNVBASIS;
+
+// Called at the beginning of main, with the arguments as given
+void ResultCache_HashArguments(int argc, char *argv[]) {
+	int i;
+
+	for (i=1; i<argc; i++)
+		resultCacheHash=CheckpointCache_Hash(resultCacheHash, argv[i], strlen(argv[i])+1);
+}
+
+// Only runs whose whole result is their output are kept
+int ResultCache_Cacheable() {
+	return strcmp(logSink, "stdout")==0 && metricsFile[0]==0 && goldenCaptureFile[0]==0
+		&& stateHashFile[0]==0 && checkpointAt<0 && checkpointInterval==0 && whatIf[0]==0
+		&& checkpointCache[0]==0 && restoreFile[0]==0 && verifyCheckpoint[0]==0 && !GEN_ASSERTS;
+}
+
+// The daemons file and the programs of the daemons, the SIP included, as the operating
+// system puts them in the program list (built here and freed, the run builds it again)
+unsigned long long ResultCache_HashDaemons(unsigned long long hash) {
+	char lineRead[MAXLINELENGTH];
+	unsigned long long fileHash;
+	FILE *daemonsFile=fopen("teachersDaemons", "r");
+	int i;
+
+	if (daemonsFile!=NULL) {
+		while (fgets(lineRead, MAXLINELENGTH, daemonsFile)!=NULL)
+			hash=CheckpointCache_Hash(hash, lineRead, strlen(lineRead));
+		fclose(daemonsFile);
+	}
+	OperatingSystem_PrepareDaemons(1);
+	for (i=0; i<PROGRAMSMAXNUMBER; i++) {
+		if (programList[i]==NULL)
+			continue;
+		hash=CheckpointCache_Hash(hash, programList[i]->executableName, strlen(programList[i]->executableName)+1);
+		fileHash=CheckpointCache_HashFile(programList[i]->executableName);
+		hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+		// The name of the SIP is a constant
+		if (i>0)
+			free(programList[i]->executableName);
+		free(programList[i]);
+		programList[i]=NULL;
+	}
+	return hash;
+}
+
+// Called once the options are set: a run in the cache ends here with its output; any
+// other one goes on in a child process whose output is kept. Returns in that child or
+// when the run is not cached
+void ResultCache_Run(int argc, char *argv[], int paramIndex) {
+	unsigned long long hash=resultCacheHash, fileHash;
+	char fileName[PATH_MAX];
+	int i;
+
+	if (resultCache[0]==0 || !ResultCache_Cacheable())
+		return;
+	fileHash=CheckpointCache_HashFile("/proc/self/exe");
+	hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	fileHash=CheckpointCache_HashFile("OperatingSystemCode");
+	hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	fileHash=CheckpointCache_HashFile(ASSERTS_FILE);
+	hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	if (STUDENT_MESSAGES_FILE[0]!=0) {
+		fileHash=CheckpointCache_HashFile(STUDENT_MESSAGES_FILE);
+		hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	}
+	if (goldenVerifyFile[0]!=0) {
+		fileHash=CheckpointCache_HashFile(goldenVerifyFile);
+		hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	}
+	hash=ResultCache_HashDaemons(hash);
+	// Programs (arrival times are hashed as files that do not exist)
+	for (i=paramIndex; i<argc; i++) {
+		fileHash=CheckpointCache_HashFile(argv[i]);
+		hash=CheckpointCache_Hash(hash, &fileHash, sizeof(fileHash));
+	}
+
+	// A run whose file does not fit is not cached
+	i=snprintf(fileName, sizeof(fileName), "%s/%016llx.out", resultCache, hash);
+	if (i<0 || i>=(int) sizeof(fileName))
+		return;
+	if (access(fileName, R_OK)==0)
+		exit(ResultCache_Replay(fileName));
+	fflush(stdout);
+	i=ResultCache_Record(fileName);
+	if (i>=0)
+		exit(i);
+}
+
+// Writes the output of a run from the cache. Returns its exit code
+int ResultCache_Replay(char *fileName) {
+	char buffer[4096];
+	size_t length;
+	int exitCode;
+	FILE *stream=fopen(fileName, "rb");
+
+	if (stream==NULL || fscanf(stream, RESULTCACHE_MAGIC " %d", &exitCode)!=1
+	 || fseek(stream, RESULTCACHE_HEADERLENGTH, SEEK_SET)!=0) {
+		printf("Result cache file %s cannot be read\n", fileName);
+		return 1;
+	}
+	while ((length=fread(buffer, 1, sizeof(buffer), stream))>0)
+		fwrite(buffer, 1, length, stdout);
+	fclose(stream);
+	fflush(stdout);
+	return exitCode;
+}
+
+// Time of the last flight recorder dump (0 if none)
+int ResultCache_FlightRecorderTime(struct timespec *time) {
+	struct stat status;
+
+	if (flightRecorderFile[0]==0 || stat(flightRecorderFile, &status)!=0)
+		return 0;
+	*time=status.st_mtim;
+	return 1;
+}
+
+// Runs the simulation in a child process and writes its output both into stdout and
+// into the cache. Returns the exit code of the child, or -1 in the child itself
+int ResultCache_Record(char *fileName) {
+	char temporaryFileName[PATH_MAX+16], buffer[4096];
+	int pipeFDs[2], pid, status, exitCode, dumpedBefore, dumpedAfter;
+	struct timespec dumpBefore, dumpAfter;
+	ssize_t length;
+	FILE *stream;
+
+	dumpedBefore=ResultCache_FlightRecorderTime(&dumpBefore);
+	if (pipe(pipeFDs)!=0)
+		return -1;
+	pid=fork();
+	if (pid<0) {
+		close(pipeFDs[0]);
+		close(pipeFDs[1]);
+		return -1;
+	}
+	if (pid==0) {
+		dup2(pipeFDs[1], STDOUT_FILENO);
+		close(pipeFDs[0]);
+		close(pipeFDs[1]);
+		return -1;
+	}
+
+	close(pipeFDs[1]);
+	snprintf(temporaryFileName, sizeof(temporaryFileName), "%s.%d", fileName, (int) getpid());
+	stream=fopen(temporaryFileName, "wb");
+	if (stream!=NULL)
+		fprintf(stream, RESULTCACHE_HEADER, 0);
+	while ((length=read(pipeFDs[0], buffer, sizeof(buffer)))>0) {
+		fwrite(buffer, 1, length, stdout);
+		if (stream!=NULL)
+			fwrite(buffer, 1, length, stream);
+	}
+	close(pipeFDs[0]);
+	fflush(stdout);
+	waitpid(pid, &status, 0);
+	exitCode=WIFEXITED(status) ? WEXITSTATUS(status) : 128+WTERMSIG(status);
+
+	if (stream!=NULL) {
+		dumpedAfter=ResultCache_FlightRecorderTime(&dumpAfter);
+		// A crashed run or one with a flight recorder dump is not kept
+		if (WIFEXITED(status) && dumpedAfter==dumpedBefore
+		 && (!dumpedAfter || (dumpAfter.tv_sec==dumpBefore.tv_sec && dumpAfter.tv_nsec==dumpBefore.tv_nsec))) {
+			fseek(stream, 0, SEEK_SET);
+			fprintf(stream, RESULTCACHE_HEADER, exitCode);
+			fclose(stream);
+			if (rename(temporaryFileName, fileName)==0)
+				return exitCode;
+		}
+		else
+			fclose(stream);
+		unlink(temporaryFileName);
+	}
+	return exitCode;
+}
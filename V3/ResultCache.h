@@ -0,0 +1,25 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include "Simulator.h"
+
+// Result cache: with resultCache (a directory), a run is identified by a hash of all its
+// inputs: the simulator, its arguments and the files it reads (the operating system code,
+// the programs and daemons, the asserts, the student messages and the golden state to
+// verify). A run found there only writes its stored output and ends with its exit code;
+// any other one is run with its output also kept there. Runs writing anything else
+// (log files, metrics, checkpoints, hashes, golden states, generated asserts or a flight
+// recorder dump) are not kept
+//   <resultCache>/<hash>.out: RESULTCACHE_MAGIC, exit code and the output
+#define RESULTCACHE_MAGIC "SIMRESULT"
+#define RESULTCACHE_HEADER "SIMRESULT %3d\n"
+#define RESULTCACHE_HEADERLENGTH 14
+
+// Functions prototypes
+void ResultCache_HashArguments(int, char *[]);
+void ResultCache_Run(int, char *[], int);
+
+// Directory of the cache (none if empty)
+extern char *resultCache;
+
+#endif
@@ -4,13 +4,25 @@
 #include "Simulator.h"
 #include "ComputerSystem.h"
 #include "Asserts.h"
-
-// Functions prototypes
-int Simulator_GetOption(char *);
+#include "Metrics.h"
+#include "Log.h"
+#include "FlightRecorder.h"
+#include "GoldenState.h"
+#include "StateHash.h"
+#include "Machine.h"
+#include "Checkpoint.h"
+#include "CheckpointCache.h"
+#include "ResultCache.h"
+#ifdef SIMULATOR_LIBRARY
+#include "Library.h"
+#endif
 
 extern int initialPID;
-extern int endSimulationTime; // For end simulation forced by time
+extern int tickless;
+extern SIMTIME endSimulationTime; // For end simulation forced by time
 extern char *debugLevel;
+extern char *statusMode; // Status reports
+extern int statusSnapshot;
 
 char *options[] = {
 "NONEXISTING_OPTION",
@@ -28,90 +40,23 @@ char *optionsDefault[]={
 NULL,
 };
 
+// The library (libsimulator.a) has everything but main
+#ifndef SIMULATOR_LIBRARY
 int main(int argc, char *argv[]) {
   
 	int paramIndex=1; // argv index
 	int i, rc, numPrograms=0, isOption=1;
 	char *option, *optionValue;
 
+	// The arguments are hashed as given, before the options are split
+	ResultCache_HashArguments(argc, argv);
+
 	// the options must be always before programs
 	for (i=paramIndex; i < argc && isOption ;) {
 		if (argv[i][0]=='-' && argv[i][1]=='-') {
 			option=strtok((char *)&(argv[i][2]),"=");
 			optionValue=strtok(NULL," ");
-			int optionIndex=Simulator_GetOption(option);
-			switch (optionIndex) {
-				// case INITIALPID:
-				case initialPID_OPT:
-					if (optionValue==NULL || sscanf(optionValue,"%d",&initialPID)==0) 
-							initialPID=PROCESSTABLEMAXSIZE-1;
-					break;
-				// case ENDSIMULATIONTIME:
-				case endSimulationTime_OPT:
-					if (optionValue==NULL || sscanf(optionValue,"%d",&endSimulationTime)==0)
-						endSimulationTime=-1;
-					break;
-				// case NUMASSERTS:
-				case numAsserts_OPT:
-					if (optionValue==NULL) 
-						MAX_ASSERTS=500;
-					else {
-						rc=sscanf(optionValue,"%d",&MAX_ASSERTS);
-						if (rc<=0 || MAX_ASSERTS<=0)
-							MAX_ASSERTS=500;
-					}
-					break;
-				// case ASSERTSFILE:
-				case assertsFile_OPT:
-					if (optionValue==NULL){
-						optionValue=(char *) malloc((strlen(optionsDefault[assertsFile_OPT])+1)*sizeof(char));
-						strcpy(optionValue,optionsDefault[assertsFile_OPT]);
-						// LOAD_ASSERTS_CONF=1;
-					}
-					strcpy(ASSERTS_FILE,optionValue);
-					break;
-				// case MESSAGESFILE:
-				case messagesSTDFile_OPT:
-					if (optionValue==NULL){
-						optionValue=(char *) malloc((strlen(optionsDefault[messagesSTDFile_OPT])+1)*sizeof(char));
-						strcpy(optionValue,optionsDefault[messagesSTDFile_OPT]);
-						// LOAD_ASSERTS_CONF=1;
-					}
-					strcpy(STUDENT_MESSAGES_FILE,optionValue);
-					break;
-				// case DEBUGSECTIONS:
-				case debugSections_OPT:
-					if (optionValue==NULL){
-						optionValue=(char *) malloc((strlen(optionsDefault[debugSections_OPT])+1)*sizeof(char));
-						strcpy(optionValue,optionsDefault[debugSections_OPT]);
-					}
-					debugLevel=optionValue;
-					break;
-				// case GENERATEASSERTS:
-				case generateAsserts_OPT:
-					GEN_ASSERTS=1; 
-					break;
-				// case HELP:
-				case help_OPT:
-					{
-						int j;
-						printf("Use one or more of these options:\n");
-						for (j=1; options[j]!=NULL; j++)
-							if (j<generateAsserts_OPT)
-								printf("\t%s=ValueOfOption  [%s]\n",options[j], optionsDefault[j]);
-							else
-								printf("\t%s\n",options[j]);
-					}
-					break;
-				// case INTERVALBETWEENINTERRUPTS:
-				case intervalBetweenInterrupts_OPT:
-					if (optionValue==NULL || sscanf(optionValue,"%d",&intervalBetweenInterrupts)<1 || intervalBetweenInterrupts<5)
-						intervalBetweenInterrupts=DEFAULT_INTERVAL_BETWEEN_INTERRUPTS;
-					break;
-				default :
-					printf("Invalid option: %s\n", option);
-					break;
-			}
+			Simulator_SetOption(option, optionValue);
 			i++;
 		}
 		else isOption=0;
@@ -136,8 +81,8 @@ int main(int argc, char *argv[]) {
 	}
 
 	// We now have a multiprogrammed computer system
-	// No more than PROGRAMSMAXNUMBER in the command line
-	if ((numPrograms<=0) || (numPrograms>PROGRAMSMAXNUMBER)) {
+	// No more than PROGRAMSMAXNUMBER in the command line (none if restoring a checkpoint)
+	if ((numPrograms<0) || (numPrograms==0 && restoreFile[0]==0) || (numPrograms>PROGRAMSMAXNUMBER)) {
 		printf("USE: Simulator [--optionX=optionXValue ...] <program1> [arrivalTime] [<program2> [arrivalTime] .... <program%d [arrivalTime]] \n",PROGRAMSMAXNUMBER);
 		if (numPrograms<0)
 			printf("Options must be before program names !!!\n");
@@ -146,7 +91,8 @@ int main(int argc, char *argv[]) {
 		exit(-1);
 	}
 
-
+	// A run already done is taken from the result cache
+	ResultCache_Run(argc, argv, paramIndex);
 
 	// The simulation starts
 	ComputerSystem_PowerOn(argc, argv, paramIndex);
@@ -154,6 +100,7 @@ int main(int argc, char *argv[]) {
 	ComputerSystem_PowerOff();
 	return 0;
 }
+#endif
 
 // to get the index number of the option
 int Simulator_GetOption(char *option){
@@ -163,3 +110,211 @@ int Simulator_GetOption(char *option){
 			return i;
 	return -1;
 }
+// Sets an option given its name and value (NULL if not given). Returns 0 if the option
+// does not exist
+int Simulator_SetOption(char *option, char *optionValue) {
+	int rc;
+	int optionIndex=Simulator_GetOption(option);
+
+
+	switch (optionIndex) {
+		// case INITIALPID:
+		case initialPID_OPT:
+			if (optionValue==NULL || sscanf(optionValue,"%d",&initialPID)==0) 
+					initialPID=PROCESSTABLEMAXSIZE-1;
+			break;
+		// case ENDSIMULATIONTIME:
+		case endSimulationTime_OPT:
+			if (optionValue==NULL || sscanf(optionValue,"%lld",&endSimulationTime)<1)
+				endSimulationTime=-1;
+			break;
+		// case NUMASSERTS:
+		case numAsserts_OPT:
+			if (optionValue==NULL) 
+				MAX_ASSERTS=500;
+			else {
+				rc=sscanf(optionValue,"%d",&MAX_ASSERTS);
+				if (rc<=0 || MAX_ASSERTS<=0)
+					MAX_ASSERTS=500;
+			}
+			break;
+		// case ASSERTSFILE:
+		case assertsFile_OPT:
+			if (optionValue==NULL){
+				optionValue=(char *) malloc((strlen(optionsDefault[assertsFile_OPT])+1)*sizeof(char));
+				strcpy(optionValue,optionsDefault[assertsFile_OPT]);
+				// LOAD_ASSERTS_CONF=1;
+			}
+			strcpy(ASSERTS_FILE,optionValue);
+			break;
+		// case MESSAGESFILE:
+		case messagesSTDFile_OPT:
+			if (optionValue==NULL){
+				optionValue=(char *) malloc((strlen(optionsDefault[messagesSTDFile_OPT])+1)*sizeof(char));
+				strcpy(optionValue,optionsDefault[messagesSTDFile_OPT]);
+				// LOAD_ASSERTS_CONF=1;
+			}
+			strcpy(STUDENT_MESSAGES_FILE,optionValue);
+			break;
+		// case DEBUGSECTIONS:
+		case debugSections_OPT:
+			if (optionValue==NULL){
+				optionValue=(char *) malloc((strlen(optionsDefault[debugSections_OPT])+1)*sizeof(char));
+				strcpy(optionValue,optionsDefault[debugSections_OPT]);
+			}
+			debugLevel=optionValue;
+			break;
+		// case GENERATEASSERTS:
+		case generateAsserts_OPT:
+			GEN_ASSERTS=1; 
+			break;
+		// case HELP:
+		case help_OPT:
+			{
+				int j;
+				printf("Use one or more of these options:\n");
+				for (j=1; options[j]!=NULL; j++)
+					if (strcmp(optionsDefault[j],"\"No value\""))
+						printf("\t%s=ValueOfOption  [%s]\n",options[j], optionsDefault[j]);
+					else
+						printf("\t%s\n",options[j]);
+			}
+			break;
+		// case INTERVALBETWEENINTERRUPTS:
+		case intervalBetweenInterrupts_OPT:
+			if (optionValue==NULL || sscanf(optionValue,"%d",&intervalBetweenInterrupts)<1 || intervalBetweenInterrupts<5)
+				intervalBetweenInterrupts=DEFAULT_INTERVAL_BETWEEN_INTERRUPTS;
+			break;
+		// case TICKLESS:
+		case tickless_OPT:
+			tickless=1;
+			break;
+		// case METRICSFILE:
+		case metricsFile_OPT:
+			if (optionValue!=NULL)
+				metricsFile=optionValue;
+			break;
+		// case METRICSFORMAT:
+		case metricsFormat_OPT:
+			if (optionValue!=NULL)
+				metricsFormat=optionValue;
+			break;
+		// case LOGSINK:
+		case logSink_OPT:
+			if (optionValue!=NULL)
+				logSink=optionValue;
+			break;
+		// case LOGFILE:
+		case logFile_OPT:
+			if (optionValue!=NULL)
+				logFile=optionValue;
+			break;
+		// case LOGFORMAT:
+		case logFormat_OPT:
+			if (optionValue!=NULL)
+				logFormat=optionValue;
+			break;
+		// case STATUSMODE:
+		case statusMode_OPT:
+			if (optionValue!=NULL)
+				statusMode=optionValue;
+			break;
+		// case STATUSSNAPSHOT:
+		case statusSnapshot_OPT:
+			if (optionValue==NULL || sscanf(optionValue,"%d",&statusSnapshot)<1 || statusSnapshot<0)
+				statusSnapshot=0;
+			break;
+		// case TRACEFILTER:
+		case traceFilter_OPT:
+			if (optionValue!=NULL)
+				traceFilterExpression=optionValue;
+			break;
+		// case FLIGHTRECORDERFILE:
+		case flightRecorderFile_OPT:
+			if (optionValue!=NULL)
+				flightRecorderFile=optionValue;
+			break;
+		// case GOLDENCAPTURE:
+		case goldenCapture_OPT:
+			if (optionValue!=NULL)
+				goldenCaptureFile=optionValue;
+			break;
+		// case GOLDENVERIFY:
+		case goldenVerify_OPT:
+			if (optionValue!=NULL)
+				goldenVerifyFile=optionValue;
+			break;
+		// case STATEHASHFILE:
+		case stateHashFile_OPT:
+			if (optionValue!=NULL)
+				stateHashFile=optionValue;
+			break;
+		// case STATEHASHINTERVAL:
+		case stateHashInterval_OPT:
+			if (optionValue==NULL || sscanf(optionValue,"%d",&stateHashInterval)<1 || stateHashInterval<1)
+				stateHashInterval=1000;
+			break;
+		// case FASTENGINE:
+		case fastEngine_OPT:
+			fastEngine=1;
+			break;
+		// case LOCKSTEP:
+		case lockstep_OPT:
+			lockstep=1;
+			break;
+		// case CHECKPOINTAT:
+		case checkpointAt_OPT:
+			if (optionValue==NULL || sscanf(optionValue,"%lld",&checkpointAt)<1)
+				checkpointAt=-1;
+			break;
+		// case CHECKPOINTFILE:
+		case checkpointFile_OPT:
+			if (optionValue!=NULL)
+				checkpointFile=optionValue;
+			break;
+		// case CHECKPOINTINTERVAL:
+		case checkpointInterval_OPT:
+			if (optionValue==NULL || sscanf(optionValue,"%d",&checkpointInterval)<1 || checkpointInterval<0)
+				checkpointInterval=0;
+			break;
+		// case RESTORE:
+		case restore_OPT:
+			if (optionValue!=NULL)
+				restoreFile=optionValue;
+			break;
+		// case VERIFYCHECKPOINT:
+		case verifyCheckpoint_OPT:
+			if (optionValue!=NULL)
+				verifyCheckpoint=optionValue;
+			break;
+		// case WHATIF:
+		case whatIf_OPT:
+			if (optionValue!=NULL)
+				whatIf=optionValue;
+			break;
+		// case CHECKPOINTCACHE:
+		case checkpointCache_OPT:
+			if (optionValue!=NULL)
+				checkpointCache=optionValue;
+			break;
+		// case RESULTCACHE:
+		case resultCache_OPT:
+			if (optionValue!=NULL)
+				resultCache=optionValue;
+			break;
+		default :
+			printf("Invalid option: %s\n", option);
+			break;
+	}
+	return optionIndex>0;
+}
+
+// A fatal error ends the simulator. In the library it only ends the simulation that had it
+void Simulator_FatalError(int status) {
+#ifdef SIMULATOR_LIBRARY
+	Library_FatalError();
+#else
+	// Pending output reaches its sink at exit
+	exit(status);
+#endif
+}
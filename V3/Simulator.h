@@ -14,6 +14,10 @@
 // Main memory size (number of memory cells)
 #define MAINMEMORYSIZE 300
 
+// Simulated time and performance counters are 64 bits wide, so that very long runs
+// do not wrap. Show them with the %l directive of the debug messages
+typedef long long SIMTIME;
+
 enum Options {
 NONEXISTING_OPT,
 #define OPTION(name,defValue) name ## _OPT, // name ## _OPT concatena y define los enumerados *_OPT
@@ -22,4 +26,13 @@ NONEXISTING_OPT,
 LAST_OPT,
 };
 
+// Sets an option given its name and value, as in the command line
+int Simulator_SetOption(char *, char *);
+
+// Index of an option given its name (-1 if it does not exist)
+int Simulator_GetOption(char *);
+
+// Ends after a fatal error (no operating system code, an unusable checkpoint...) with status
+void Simulator_FatalError(int);
+
 #endif
@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include "StateHash.h"
+#include "Asserts.h"
+#include "AssertsFile.h"
+#include "Clock.h"
+#include "ComputerSystem.h"
+
+unsigned long long StateHash_Mix(int, int, int);
+void StateHash_Write(SIMTIME);
+
+char *stateHashFile="";
+int stateHashInterval=1000;
+
+extern MEMORYCELL mainMemory[];
+
+FILE *stateHashStream=NULL;
+SIMTIME nextStateHashTick=0;
+
+// Main memory part of the hash, kept up to date on every write
+unsigned long long memoryHash=0;
+
+// Every (element, address, value) gets a pseudorandom key (splitmix64); the hash is
+// the xor of the keys, so a change is undone and redone in constant time
+unsigned long long StateHash_Mix(int element, int address, int value) {
+	unsigned long long key=((unsigned long long) element << 48) ^ ((unsigned long long) address << 32) ^ (unsigned int) value;
+
+	key+=0x9E3779B97F4A7C15ULL;
+	key=(key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	key=(key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+	return key ^ (key >> 31);
+}
+
+void StateHash_Initialize() {
+	int address;
+
+	if (stateHashFile[0]==0)
+		return;
+	stateHashStream=fopen(stateHashFile, "w");
+	if (stateHashStream==NULL) {
+		ComputerSystem_DebugMessage(80,POWERON,stateHashFile);
+		return;
+	}
+	for (address=0; address<MAINMEMORYSIZE; address++)
+		memoryHash^=StateHash_Mix(AMEM, address, mainMemory[address]);
+}
+
+// Main memory tells every write, before the cell changes
+void StateHash_MemoryWritten(int address, MEMORYCELL oldValue, MEMORYCELL newValue) {
+	if (stateHashStream!=NULL)
+		memoryHash^=StateHash_Mix(AMEM, address, oldValue) ^ StateHash_Mix(AMEM, address, newValue);
+}
+
+unsigned long long StateHash_Get() {
+	unsigned long long hash=memoryHash;
+	int element, address, addresses;
+
+	for (element=0; element<NUMBEROFASSERTELEMENTS; element++) {
+		if (!elementGolden[element] || elementAddress[element]==ASSERT_MEMORYADDRESS)
+			continue;
+		addresses=elementAddress[element]==ASSERT_PCBADDRESS ? PROCESSTABLEMAXSIZE : 1;
+		for (address=0; address<addresses; address++)
+			hash^=StateHash_Mix(element, address, Asserts_ReadElement(element, address));
+	}
+	return hash;
+}
+
+void StateHash_Write(SIMTIME tick) {
+	fprintf(stateHashStream, "%lld %016llx\n", tick, StateHash_Get());
+}
+
+// Called after every instruction
+void StateHash_Check() {
+	SIMTIME tick;
+
+	if (stateHashStream==NULL || (tick=Clock_GetTime())<nextStateHashTick)
+		return;
+	StateHash_Write(tick);
+	nextStateHashTick=(tick/stateHashInterval+1)*stateHashInterval;
+}
+
+// The state at the end is always written
+void StateHash_Terminate() {
+	if (stateHashStream==NULL)
+		return;
+	StateHash_Write(Clock_GetTime());
+	fclose(stateHashStream);
+	stateHashStream=NULL;
+}
@@ -0,0 +1,23 @@
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include "Simulator.h"
+#include "MainMemory.h"
+
+// Rolling hash of the architectural state (the golden elements of AssertElements.def).
+// Memory cells are hashed again only when written; registers and PCB fields when the
+// hash is taken. Every stateHashInterval ticks a line "tick hash" is written into
+// stateHashFile, and the last one when the simulation ends (see the simbisect tool)
+
+// Functions prototypes
+void StateHash_Initialize();
+void StateHash_MemoryWritten(int, MEMORYCELL, MEMORYCELL);
+unsigned long long StateHash_Get();
+void StateHash_Check();
+void StateHash_Terminate();
+
+// Hashes file (none if empty) and ticks between hashes
+extern char *stateHashFile;
+extern int stateHashInterval;
+
+#endif
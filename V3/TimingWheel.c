@@ -0,0 +1,239 @@
+#include "TimingWheel.h"
+
+// Internal Functions prototypes
+int TimingWheel_ListFor(TIMINGWHEEL *, SIMTIME);
+void TimingWheel_Link(TIMINGWHEEL *, int, int);
+void TimingWheel_Unlink(TIMINGWHEEL *, int);
+void TimingWheel_Cascade(TIMINGWHEEL *, SIMTIME);
+SIMTIME TimingWheel_NextChange(TIMINGWHEEL *);
+void TimingWheel_Removed(TIMINGWHEEL *, int);
+int TimingWheel_ExtractList(TIMINGWHEEL *, int, int[], int);
+void TimingWheel_SortByDeadline(TIMINGWHEEL *, int[], int);
+
+// Empties the wheel and sets its current time
+void TimingWheel_Initialize(TIMINGWHEEL *wheel, SIMTIME now) {
+	int i;
+
+	wheel->now=now;
+	wheel->numberOfItems=0;
+	wheel->firstDeadline=-1;
+	for (i=0; i<TIMINGWHEEL_NUMBEROFLISTS; i++)
+		wheel->first[i]=TIMINGWHEEL_EMPTY;
+	for (i=0; i<TIMINGWHEELMAXITEMS; i++)
+		wheel->list[i]=TIMINGWHEEL_EMPTY;
+}
+
+// Insertion of an item with its deadline
+// return 0/-1  ok/fail
+int TimingWheel_Insert(TIMINGWHEEL *wheel, int item, SIMTIME deadline) {
+	if (item<0 || item>=TIMINGWHEELMAXITEMS || wheel->list[item]!=TIMINGWHEEL_EMPTY)
+		return -1;
+	wheel->deadline[item]=deadline;
+	TimingWheel_Link(wheel, item, TimingWheel_ListFor(wheel, deadline));
+	wheel->numberOfItems++;
+	if (wheel->firstDeadline==-1 || (wheel->firstDeadline!=TIMINGWHEEL_UNKNOWN && deadline<wheel->firstDeadline))
+		wheel->firstDeadline=deadline;
+	return 0;
+}
+
+// Removal of an item before its deadline
+// return 0/-1  ok/fail
+int TimingWheel_Cancel(TIMINGWHEEL *wheel, int item) {
+	if (item<0 || item>=TIMINGWHEELMAXITEMS || wheel->list[item]==TIMINGWHEEL_EMPTY)
+		return -1;
+	TimingWheel_Unlink(wheel, item);
+	TimingWheel_Removed(wheel, item);
+	return 0;
+}
+
+// Moves the wheel time up to "now", extracting into "expired" all the items whose
+// deadline is reached. Returns the number of extracted items
+int TimingWheel_Advance(TIMINGWHEEL *wheel, SIMTIME now, int expired[]) {
+	int numberOfExpired;
+	SIMTIME next;
+
+	// Items inserted when their deadline had already passed go first
+	numberOfExpired=TimingWheel_ExtractList(wheel, TIMINGWHEEL_EXPIRED, expired, 0);
+	TimingWheel_SortByDeadline(wheel, expired, numberOfExpired);
+
+	while (wheel->now < now) {
+		next=TimingWheel_NextChange(wheel);
+		if (next<0 || next>now) { // Nothing to expire or cascade up to now, jump directly
+			wheel->now=now;
+			break;
+		}
+		// Times in between have empty slots: going through them would change nothing
+		wheel->now=next;
+		TimingWheel_Cascade(wheel, wheel->now);
+		// Every item in the level 0 slot of the current time has exactly this deadline
+		numberOfExpired=TimingWheel_ExtractList(wheel, (int) (wheel->now & TIMINGWHEEL_SLOTMASK), expired, numberOfExpired);
+	}
+	return numberOfExpired;
+}
+
+// Copies all the items sorted by deadline. Returns the number of items
+int TimingWheel_GetItems(TIMINGWHEEL *wheel, int items[]) {
+	int i, numberOfItems=0;
+
+	for (i=0; i<TIMINGWHEELMAXITEMS; i++)
+		if (wheel->list[i]!=TIMINGWHEEL_EMPTY)
+			items[numberOfItems++]=i;
+	TimingWheel_SortByDeadline(wheel, items, numberOfItems);
+	return numberOfItems;
+}
+
+// Returns the earliest deadline or -1 if the wheel is empty
+SIMTIME TimingWheel_GetFirstDeadline(TIMINGWHEEL *wheel) {
+	int i;
+	SIMTIME firstDeadline=-1;
+
+	if (wheel->firstDeadline!=TIMINGWHEEL_UNKNOWN)
+		return wheel->firstDeadline;
+	for (i=0; i<TIMINGWHEELMAXITEMS; i++)
+		if (wheel->list[i]!=TIMINGWHEEL_EMPTY && (firstDeadline==-1 || wheel->deadline[i]<firstDeadline))
+			firstDeadline=wheel->deadline[i];
+	wheel->firstDeadline=firstDeadline;
+	return firstDeadline;
+}
+
+// An item has left the wheel. If it was the earliest one, the next has to be found again
+void TimingWheel_Removed(TIMINGWHEEL *wheel, int item) {
+	wheel->numberOfItems--;
+	if (wheel->numberOfItems==0)
+		wheel->firstDeadline=-1;
+	else if (wheel->deadline[item]==wheel->firstDeadline)
+		wheel->firstDeadline=TIMINGWHEEL_UNKNOWN;
+}
+
+// First time after the wheel time when a non-empty slot expires (level 0) or is
+// cascaded (upper levels and overflow list). -1 if the wheel is empty.
+// Slot S of level L is reached when the time is a multiple of SLOTS^L whose
+// level L digit is S: the first one after now is found from the digits of now
+SIMTIME TimingWheel_NextChange(TIMINGWHEEL *wheel) {
+	int level, slot, shift;
+	SIMTIME turn, digit, time, next=-1;
+
+	if (wheel->numberOfItems==0)
+		return -1;
+	for (level=0; level<TIMINGWHEEL_LEVELS; level++) {
+		shift=TIMINGWHEEL_SLOTBITS*level;
+		turn=(wheel->now >> shift) & ~(SIMTIME) TIMINGWHEEL_SLOTMASK;
+		for (slot=0; slot<TIMINGWHEEL_SLOTS; slot++) {
+			if (wheel->first[level*TIMINGWHEEL_SLOTS+slot]==TIMINGWHEEL_EMPTY)
+				continue;
+			digit=turn | slot;
+			if (digit <= (wheel->now >> shift))
+				digit+=TIMINGWHEEL_SLOTS;
+			time=digit << shift;
+			if (next<0 || time<next)
+				next=time;
+		}
+	}
+	if (wheel->first[TIMINGWHEEL_OVERFLOW]!=TIMINGWHEEL_EMPTY) {
+		shift=TIMINGWHEEL_SLOTBITS*TIMINGWHEEL_LEVELS;
+		time=((wheel->now >> shift) + 1) << shift;
+		if (next<0 || time<next)
+			next=time;
+	}
+	return next;
+}
+
+// Selects the list for a deadline: the lowest level whose range covers the time left
+int TimingWheel_ListFor(TIMINGWHEEL *wheel, SIMTIME deadline) {
+	int level;
+	SIMTIME timeLeft=deadline - wheel->now;
+
+	if (timeLeft<=0)
+		return TIMINGWHEEL_EXPIRED;
+	for (level=0; level<TIMINGWHEEL_LEVELS; level++)
+		if (timeLeft < ((SIMTIME) 1 << (TIMINGWHEEL_SLOTBITS*(level+1))))
+			return level*TIMINGWHEEL_SLOTS + (int) ((deadline >> (TIMINGWHEEL_SLOTBITS*level)) & TIMINGWHEEL_SLOTMASK);
+	return TIMINGWHEEL_OVERFLOW;
+}
+
+// Appends an item at the end of a list
+void TimingWheel_Link(TIMINGWHEEL *wheel, int item, int list) {
+	int first=wheel->first[list];
+
+	if (first==TIMINGWHEEL_EMPTY) {
+		wheel->next[item]=wheel->previous[item]=item;
+		wheel->first[list]=item;
+	}
+	else {
+		wheel->next[item]=first;
+		wheel->previous[item]=wheel->previous[first];
+		wheel->next[wheel->previous[first]]=item;
+		wheel->previous[first]=item;
+	}
+	wheel->list[item]=list;
+}
+
+// Removes an item from its list
+void TimingWheel_Unlink(TIMINGWHEEL *wheel, int item) {
+	int list=wheel->list[item];
+
+	if (wheel->next[item]==item)
+		wheel->first[list]=TIMINGWHEEL_EMPTY;
+	else {
+		wheel->next[wheel->previous[item]]=wheel->next[item];
+		wheel->previous[wheel->next[item]]=wheel->previous[item];
+		if (wheel->first[list]==item)
+			wheel->first[list]=wheel->next[item];
+	}
+	wheel->list[item]=TIMINGWHEEL_EMPTY;
+}
+
+// When lower levels complete a turn, items of the next slot of the upper levels
+// are distributed again, now with a finer granularity
+void TimingWheel_Cascade(TIMINGWHEEL *wheel, SIMTIME now) {
+	int level, list, item, last, nextItem, newList;
+
+	for (level=TIMINGWHEEL_LEVELS; level>0; level--) {
+		if (now & (((SIMTIME) 1 << (TIMINGWHEEL_SLOTBITS*level)) - 1))
+			continue; // Lower levels have not completed a turn
+		if (level==TIMINGWHEEL_LEVELS)
+			list=TIMINGWHEEL_OVERFLOW; // Far items may go back to the overflow list
+		else
+			list=level*TIMINGWHEEL_SLOTS + (int) ((now >> (TIMINGWHEEL_SLOTBITS*level)) & TIMINGWHEEL_SLOTMASK);
+		// Detach the whole list before distributing its items
+		item=wheel->first[list];
+		if (item==TIMINGWHEEL_EMPTY)
+			continue;
+		wheel->first[list]=TIMINGWHEEL_EMPTY;
+		last=wheel->previous[item];
+		do {
+			nextItem=wheel->next[item];
+			newList=TimingWheel_ListFor(wheel, wheel->deadline[item]);
+			if (newList==TIMINGWHEEL_EXPIRED) // Reached the current time
+				newList=(int) (now & TIMINGWHEEL_SLOTMASK);
+			TimingWheel_Link(wheel, item, newList);
+			if (item==last)
+				break;
+			item=nextItem;
+		} while (1);
+	}
+}
+
+// Moves all the items of a list to the array from position numberOfItems
+int TimingWheel_ExtractList(TIMINGWHEEL *wheel, int list, int items[], int numberOfItems) {
+	int item;
+
+	while ((item=wheel->first[list])!=TIMINGWHEEL_EMPTY) {
+		TimingWheel_Unlink(wheel, item);
+		TimingWheel_Removed(wheel, item);
+		items[numberOfItems++]=item;
+	}
+	return numberOfItems;
+}
+
+// Stable insertion sort by deadline, used only for small arrays
+void TimingWheel_SortByDeadline(TIMINGWHEEL *wheel, int items[], int numberOfItems) {
+	int i, j, item;
+
+	for (i=1; i<numberOfItems; i++) {
+		item=items[i];
+		for (j=i; j>0 && wheel->deadline[items[j-1]]>wheel->deadline[item]; j--)
+			items[j]=items[j-1];
+		items[j]=item;
+	}
+}
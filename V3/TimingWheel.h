@@ -0,0 +1,63 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include "Simulator.h"
+
+// Hierarchical timing wheel: TIMINGWHEEL_LEVELS wheels of TIMINGWHEEL_SLOTS slots each.
+// Level L slots cover (TIMINGWHEEL_SLOTS^L) time units, so deadlines up to
+// TIMINGWHEEL_SLOTS^TIMINGWHEEL_LEVELS units ahead are kept in the wheels and farther
+// ones wait in an overflow list
+#define TIMINGWHEEL_SLOTBITS 6
+#define TIMINGWHEEL_SLOTS (1 << TIMINGWHEEL_SLOTBITS)
+#define TIMINGWHEEL_SLOTMASK (TIMINGWHEEL_SLOTS - 1)
+#define TIMINGWHEEL_LEVELS 4
+
+// Items are identified by an integer in [0, TIMINGWHEELMAXITEMS), PIDs for the sleeping queue
+#define TIMINGWHEELMAXITEMS PROCESSTABLEMAXSIZE
+
+// Every list of the wheel is a circular doubly linked list of items. Lists are numbered:
+// slot S of level L is list L*TIMINGWHEEL_SLOTS+S, followed by the expired and overflow lists
+#define TIMINGWHEEL_EXPIRED (TIMINGWHEEL_LEVELS * TIMINGWHEEL_SLOTS)
+#define TIMINGWHEEL_OVERFLOW (TIMINGWHEEL_EXPIRED + 1)
+#define TIMINGWHEEL_NUMBEROFLISTS (TIMINGWHEEL_OVERFLOW + 1)
+
+#define TIMINGWHEEL_EMPTY -1
+
+// Cached first deadline that has to be found again
+#define TIMINGWHEEL_UNKNOWN -2
+
+typedef struct {
+	SIMTIME now; // Last time processed by TimingWheel_Advance
+	int numberOfItems;
+	SIMTIME firstDeadline; // Earliest deadline, -1 if empty or TIMINGWHEEL_UNKNOWN
+	int first[TIMINGWHEEL_NUMBEROFLISTS]; // First item of each list or TIMINGWHEEL_EMPTY
+	int next[TIMINGWHEELMAXITEMS];
+	int previous[TIMINGWHEELMAXITEMS];
+	SIMTIME deadline[TIMINGWHEELMAXITEMS];
+	int list[TIMINGWHEELMAXITEMS]; // List the item is linked in or TIMINGWHEEL_EMPTY
+} TIMINGWHEEL;
+
+// Empties the wheel and sets its current time
+void TimingWheel_Initialize(TIMINGWHEEL *, SIMTIME);
+
+// Inserts an item with the given deadline in O(1).
+// Returns 0/-1 ok/fail (invalid item or item already in the wheel)
+int TimingWheel_Insert(TIMINGWHEEL *, int, SIMTIME);
+
+// Removes an item before its deadline in O(1). Returns 0/-1 ok/fail (item not in the wheel)
+int TimingWheel_Cancel(TIMINGWHEEL *, int);
+
+// Moves the wheel time forward up to the given time and extracts, as one batch, every
+// item whose deadline has passed, in deadline order (insertion order for equal deadlines).
+// Time goes straight to the next slot to expire or cascade, whatever the gap
+// The array must have room for TIMINGWHEELMAXITEMS items. Returns the number of extracted items
+int TimingWheel_Advance(TIMINGWHEEL *, SIMTIME, int[]);
+
+// Copies the items in the wheel to the array sorted by deadline. Returns the number of items
+int TimingWheel_GetItems(TIMINGWHEEL *, int[]);
+
+// Returns the earliest deadline into the wheel or -1 if it is empty. It is kept, so only
+// the removal of the earliest item makes the next call look for it again
+SIMTIME TimingWheel_GetFirstDeadline(TIMINGWHEEL *);
+
+#endif
@@ -0,0 +1,43 @@
+#include "Varint.h"
+
+// Encodes value into bytes (VARINT_MAXLENGTH long). Returns its length
+int Varint_Encode(unsigned long long value, unsigned char *bytes) {
+	int length=0;
+
+	while (value>=0x80) {
+		bytes[length++]=(value & 0x7f) | 0x80;
+		value>>=7;
+	}
+	bytes[length++]=value;
+	return length;
+}
+
+// Returns 0 if the value has been written
+int Varint_Write(FILE *stream, unsigned long long value) {
+	unsigned char bytes[VARINT_MAXLENGTH];
+	int length=Varint_Encode(value, bytes);
+
+	return fwrite(bytes, 1, length, stream)==(size_t) length ? 0 : -1;
+}
+
+// Returns 0 if a whole value has been read
+int Varint_Read(FILE *stream, unsigned long long *value) {
+	int byte, shift=0;
+
+	*value=0;
+	do {
+		if ((byte=getc(stream))==EOF || shift>63)
+			return -1;
+		*value|=(unsigned long long) (byte & 0x7f) << shift;
+		shift+=7;
+	} while (byte & 0x80);
+	return 0;
+}
+
+unsigned long long Varint_ZigZag(long long value) {
+	return ((unsigned long long) value << 1) ^ (unsigned long long) (value >> 63);
+}
+
+long long Varint_UnZigZag(unsigned long long encoded) {
+	return (long long) (encoded >> 1) ^ -(long long) (encoded & 1);
+}
@@ -0,0 +1,18 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <stdio.h>
+
+// Varints, used by the binary log and the golden state files: seven bits per byte, the
+// high bit tells that more bytes follow. Signed values are zigzag encoded first, so
+// small negative values get short varints too
+#define VARINT_MAXLENGTH 10
+
+// Functions prototypes
+int Varint_Encode(unsigned long long, unsigned char *);
+int Varint_Write(FILE *, unsigned long long);
+int Varint_Read(FILE *, unsigned long long *);
+unsigned long long Varint_ZigZag(long long);
+long long Varint_UnZigZag(unsigned long long);
+
+#endif
@@ -1,10 +1,26 @@
 #include "Clock.h"
 #include "Asserts.h"
+#include "GoldenState.h"
+#include "StateHash.h"
+#include "ComputerSystem.h"
+#include "ComputerSystemBase.h"
+#include "Processor.h"
+#include "Metrics.h"
+#include "Checkpoint.h"
+#include "CheckpointCache.h"
+#include "Events.h"
 
 void __real_OperatingSystem_InterruptLogic(int);
 int __real_Processor_FetchInstruction();
 void __real_Processor_DecodeAndExecuteInstruction();
 void __real_Processor_InstructionCycleLoop();
+void Wrappers_CheckEndSimulationTime();
+int Wrappers_EveryInstruction();
+
+extern int interruptLines_CPU;
+
+// Set when the OS is entered: it may schedule events before the one batches run up to
+int wrappersOSEntered=0;
 
 void __wrap_Processor_InstructionCycleLoop() {
 	__real_Processor_InstructionCycleLoop();
@@ -12,17 +28,66 @@ void __wrap_Processor_InstructionCycleLoop() {
 }
 
 int __wrap_Processor_FetchInstruction() {
+	if (Checkpoint_Check())
+		return CPU_FAIL;
+	CheckpointCache_Check();
 	Clock_Update();
+	Metrics_ChargeTick();
 	return __real_Processor_FetchInstruction();
 }
 
 void __wrap_Processor_DecodeAndExecuteInstruction() {
 	__real_Processor_DecodeAndExecuteInstruction();
 	Asserts_CheckAsserts();
+	GoldenState_Check();
+	StateHash_Check();
+	Wrappers_CheckEndSimulationTime();
 }
 
 void __wrap_OperatingSystem_InterruptLogic(int entryPoint) {
+	wrappersOSEntered=1;
 	Clock_Update();
+	Metrics_ChargeTick();
 	__real_OperatingSystem_InterruptLogic(entryPoint);
+	Wrappers_CheckEndSimulationTime();
+}
+
+// With --endSimulationTime the processor is powered off when the clock reaches it
+void Wrappers_CheckEndSimulationTime() {
+	if (endSimulationTime>=0 && Clock_GetTime()>=endSimulationTime && !Processor_PSW_BitState(POWEROFF_BIT)) {
+		ComputerSystem_DebugMessage(99,SHUTDOWN,"End of simulation time reached\n");
+		Processor_ActivatePSW_Bit(POWEROFF_BIT);
+	}
 }
 
+// Checks done on every fetch or instruction other than the events: with any of them
+// the instructions go one by one through the wrappers
+int Wrappers_EveryInstruction() {
+	return Asserts_CheckedEveryInstruction() || goldenCaptureFile[0]!=0 || goldenVerifyFile[0]!=0
+		|| stateHashFile[0]!=0 || checkpointAt>=0 || checkpointInterval>0 || verifyCheckpoint[0]!=0
+		|| checkpointCache[0]!=0;
+}
+
+// Runs at once the instructions before the next event: the clock only has to tick for
+// them, and the end of the simulation cannot come. Interrupts end the batch, as does
+// an entry into the OS or the power off. Returns the number of instructions run
+int Wrappers_RunUntilNextEvent() {
+	SIMTIME limit=Events_NextEventTime();
+	int instructions=0;
+
+	if (Wrappers_EveryInstruction())
+		return 0;
+	if (endSimulationTime>=0 && endSimulationTime<limit)
+		limit=endSimulationTime;
+	wrappersOSEntered=0;
+	while (Clock_GetTime()+1<limit && !interruptLines_CPU && !wrappersOSEntered
+	 && !Processor_PSW_BitState(POWEROFF_BIT)) {
+		Clock_Advance();
+		// The executing process and the mode may change at any instruction
+		Metrics_ChargeTick();
+		if (__real_Processor_FetchInstruction()==CPU_SUCCESS)
+			__real_Processor_DecodeAndExecuteInstruction();
+		instructions++;
+	}
+	return instructions;
+}
@@ -5,5 +5,6 @@ void __wrap_Processor_InstructionCycleLoop();
 int __wrap_Processor_FetchInstruction();
 void __wrap_Processor_DecodeAndExecuteInstruction();
 void __wrap_OperatingSystem_InterruptLogic(int);
+int Wrappers_RunUntilNextEvent();
 
 #endif
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <string.h>
+#include "Messages.h"
+
+// mkmessages: build step that turns message files into the catalogue compiled into
+// the simulator (see Messages_LoadCatalogue). Lines are read as the simulator reads
+// message files at run time
+//   mkmessages messagesFile ... > MessagesCatalogue.c
+
+// Format as a C string literal
+void MkMessages_WriteString(const char *text) {
+	putchar('"');
+	for (; *text!=0; text++) {
+		if (*text=='"' || *text=='\\')
+			putchar('\\');
+		putchar(*text);
+	}
+	putchar('"');
+}
+
+int main(int argc, char *argv[]) {
+	char lineRead[MSGMAXIMUMLENGTH];
+	FILE *mf;
+	char *number, *text;
+	int msgNumber, lineNumber, i;
+
+	if (argc<2) {
+		fprintf(stderr, "USE: mkmessages messagesFile ... > MessagesCatalogue.c\n");
+		return 1;
+	}
+	printf("// Generated by mkmessages from the message files. Do not edit\n");
+	printf("#include <stddef.h>\n#include \"Messages.h\"\n\n");
+	printf("MESSAGES_CATALOGUE_ENTRY messagesCatalogue[]={\n");
+	for (i=1; i<argc; i++) {
+		mf=fopen(argv[i], "r");
+		if (mf==NULL) {
+			fprintf(stderr, "mkmessages: missing message file %s\n", argv[i]);
+			return 1;
+		}
+		lineNumber=0;
+		while (fgets(lineRead, MSGMAXIMUMLENGTH, mf) != NULL) {
+			lineNumber++;
+			number=strtok(lineRead,",");
+			if ((number==NULL) || (number[0]=='/') || (number[0]=='\n') || (number[0]=='\r'))
+				continue;
+			text=strtok(NULL,"\n");
+			if (sscanf(number,"%d",&msgNumber)!=1 || msgNumber<0 || msgNumber>=MSGMAXNUMBER || text==NULL) {
+				// Skipped, as the simulator does with a wrong line
+				fprintf(stderr, "%s:%d: illegal message, skipped\n", argv[i], lineNumber);
+				continue;
+			}
+			printf("\t{\"%s\", %d, ", argv[i], msgNumber);
+			MkMessages_WriteString(text);
+			printf("},\n");
+		}
+		fclose(mf);
+	}
+	printf("\t{NULL, -1, NULL}\n};\n");
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "AssertsFile.h"
+#include "ProcessorBase.h"
+
+// simasserts: compiles a text asserts file into a binary one, sorted by time, that the
+// simulator reads while running, with no limit of asserts; or shows a binary one as text
+//   simasserts textAssertsFile binaryAssertsFile
+//   simasserts --text binaryAssertsFile
+
+// All time asserts (time -33) go first, whatever the times of the others, which are
+// sorted by time. Asserts of the same time keep the order of the text file
+int Simasserts_Compare(const void *a, const void *b) {
+	const ASSERTSFILE_RECORD *first=a, *second=b;
+
+	if ((first->time==-33)!=(second->time==-33))
+		return first->time==-33 ? -1 : 1;
+	if (first->time!=second->time)
+		return first->time<second->time ? -1 : 1;
+	return first->lineNumber-second->lineNumber;
+}
+
+int Simasserts_Compile(char *textFile, char *binaryFile) {
+	ASSERTSFILE_HEADER header;
+	ASSERTSFILE_RECORD *records=NULL;
+	ASSERT_DATA a;
+	char lineRead[MAXIMUMLENGTH];
+	char *value;
+	long long numberOfAsserts=0, size=0;
+	int lineNumber=0, rc;
+	FILE *input, *output;
+
+	input=fopen(textFile, "r");
+	if (input==NULL) {
+		printf("Asserts file %s cannot be opened\n", textFile);
+		return 1;
+	}
+	memset(&header, 0, sizeof(header));
+	while (fgets(lineRead, MAXIMUMLENGTH, input)!=NULL) {
+		lineNumber++;
+		rc=AssertsFile_ParseLine(lineRead, &a, &value);
+		if (rc==ASSERTSFILE_SKIP)
+			continue;
+		if (rc>0) {
+			fprintf(stderr, "Illegal assert in line %d of file %s\n", lineNumber, textFile);
+			continue;
+		}
+		if (numberOfAsserts==size) {
+			size=size ? size*2 : 1024;
+			records=(ASSERTSFILE_RECORD *) realloc(records, size*sizeof(ASSERTSFILE_RECORD));
+			if (records==NULL) {
+				printf("Not enough memory for %lld asserts\n", size);
+				return 1;
+			}
+		}
+		memset(&records[numberOfAsserts], 0, sizeof(ASSERTSFILE_RECORD));
+		records[numberOfAsserts].time=a.time;
+		records[numberOfAsserts].element=a.element;
+		records[numberOfAsserts].value=a.value;
+		records[numberOfAsserts].address=a.address;
+		records[numberOfAsserts].lineNumber=lineNumber;
+		if (a.time==-33)
+			header.numberOfAllTimeAsserts++;
+		numberOfAsserts++;
+	}
+	fclose(input);
+
+	qsort(records, numberOfAsserts, sizeof(ASSERTSFILE_RECORD), Simasserts_Compare);
+
+	memcpy(header.magic, ASSERTSFILE_MAGIC, ASSERTSFILE_MAGICLENGTH);
+	header.recordSize=sizeof(ASSERTSFILE_RECORD);
+	header.numberOfAsserts=numberOfAsserts;
+	output=fopen(binaryFile, "wb");
+	if (output==NULL
+	 || fwrite(&header, sizeof(header), 1, output)!=1
+	 || (long long) fwrite(records, sizeof(ASSERTSFILE_RECORD), numberOfAsserts, output)!=numberOfAsserts
+	 || fclose(output)!=0) {
+		printf("Binary asserts file %s cannot be written\n", binaryFile);
+		return 1;
+	}
+	free(records);
+	printf("%lld asserts (%d for all time) written to %s\n", numberOfAsserts, header.numberOfAllTimeAsserts, binaryFile);
+	return 0;
+}
+
+int Simasserts_Text(char *binaryFile) {
+	ASSERTSFILE_HEADER header;
+	ASSERTSFILE_CURSOR cursor;
+	ASSERTSFILE_RECORD *record;
+
+	if (AssertsFile_Open(binaryFile, &cursor, &header)<0) {
+		printf("%s is not a binary asserts file\n", binaryFile);
+		return 1;
+	}
+	for (; (record=AssertsFile_Peek(&cursor))!=NULL; AssertsFile_Next(&cursor)) {
+		if (record->element<0 || record->element>=NUMBEROFASSERTELEMENTS)
+			continue;
+		if (record->time==-33)
+			printf("*");
+		else
+			printf("%lld", record->time);
+		printf(",%s", elements[record->element]);
+		if (elementValueIsInstruction[record->element] && record->value>=0 && record->value<LAST_INST)
+			printf(",%s", InstructionNames[record->value]);
+		else
+			printf(",%d", record->value);
+		if (elementAddress[record->element]!=ASSERT_NOADDRESS)
+			printf(",%d", record->address);
+		printf("\n");
+	}
+	AssertsFile_Close(&cursor);
+	return 0;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc==3 && strcmp(argv[1], "--text")==0)
+		return Simasserts_Text(argv[2]);
+	if (argc==3 && strncmp(argv[1], "--", 2))
+		return Simasserts_Compile(argv[1], argv[2]);
+	printf("USE: simasserts textAssertsFile binaryAssertsFile\n     simasserts --text binaryAssertsFile\n");
+	return 1;
+}
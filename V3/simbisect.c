@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+
+// simbisect: finds the first tick where two runs of the simulator differ, by their
+// state hashes (--stateHashFile)
+//   simbisect hashFileA hashFileB
+//		compares two streams of hashes already written
+//   simbisect [--interval=K] "simulator command A" "simulator command B"
+//		runs both commands hashing and taking a checkpoint every K ticks (1000 by
+//		default) and then bisects the first different interval, running both again
+//		from their last checkpoint with the same state up to the middle tick
+//		(--endSimulationTime) until the first different tick is found. A run may end
+//		a tick past the middle one: the tick it reached is the one bisected
+// The commands are the simulator and its options and programs; the hash options
+// are inserted after the first word
+
+#define SIMBISECT_COMMANDLENGTH 4096
+
+typedef struct {
+	long long tick;
+	unsigned long long hash;
+} STATE_HASH;
+
+#define SIMBISECT_TEMPORARY "/tmp"
+
+char simbisectFiles[2][64];
+char simbisectCheckpoints[2][80];
+
+// Reads the next hash of a stream, 0 at the end
+int Simbisect_ReadHash(FILE *stream, STATE_HASH *hash) {
+	return fscanf(stream, "%lld %llx", &hash->tick, &hash->hash)==2;
+}
+
+// Compares two streams of hashes. Returns 0 if equal or 1 and the last equal tick
+// (-1 if none) and the first different one
+int Simbisect_Compare(char *fileA, char *fileB, long long *lastEqual, long long *firstDifferent) {
+	FILE *streamA, *streamB;
+	STATE_HASH hashA, hashB;
+	int readA, readB, different=0;
+
+	streamA=fopen(fileA, "r");
+	streamB=fopen(fileB, "r");
+	if (streamA==NULL || streamB==NULL) {
+		printf("Hash file %s cannot be read\n", streamA==NULL ? fileA : fileB);
+		exit(1);
+	}
+	*lastEqual=-1;
+	for (;;) {
+		readA=Simbisect_ReadHash(streamA, &hashA);
+		readB=Simbisect_ReadHash(streamB, &hashB);
+		if (!readA && !readB)
+			break;
+		if (readA!=readB || hashA.tick!=hashB.tick || hashA.hash!=hashB.hash) {
+			different=1;
+			*firstDifferent=!readA ? hashB.tick : !readB ? hashA.tick : hashA.tick<hashB.tick ? hashA.tick : hashB.tick;
+			break;
+		}
+		*lastEqual=hashA.tick;
+	}
+	fclose(streamA);
+	fclose(streamB);
+	return different;
+}
+
+// Runs a simulator command with the hash options into simbisectFiles[run]. A run to the
+// end (endTime -1) also takes the checkpoints, any other one goes on from the one taken
+// at restoreTime (none if negative)
+void Simbisect_Run(char *command, int run, int interval, long long endTime, long long restoreTime) {
+	char line[SIMBISECT_COMMANDLENGTH], checkpoints[128]="";
+	int program=strcspn(command, " ");
+
+	if (endTime<0)
+		snprintf(checkpoints, sizeof(checkpoints), " --checkpointInterval=%d --checkpointFile=%s", interval, simbisectCheckpoints[run]);
+	else if (restoreTime>=0)
+		snprintf(checkpoints, sizeof(checkpoints), " --restore=%s.%lld", simbisectCheckpoints[run], restoreTime);
+	snprintf(line, sizeof(line), "%.*s --stateHashFile=%s --stateHashInterval=%d --endSimulationTime=%lld%s%s > /dev/null 2>&1",
+		program, command, simbisectFiles[run], interval, endTime, checkpoints, &command[program]);
+	if (system(line)==-1) {
+		printf("%s cannot be run\n", command);
+		exit(1);
+	}
+}
+
+// Latest time, not after lastEqual, with a checkpoint of both runs (-1 if none). Their
+// states are the same there, as the hashes up to lastEqual are
+long long Simbisect_Checkpoint(long long lastEqual) {
+	char *name=strrchr(simbisectCheckpoints[0], '/')+1, fileB[128];
+	int nameLength=strlen(name), length;
+	long long time, latest=-1;
+	DIR *dir=opendir(SIMBISECT_TEMPORARY);
+	struct dirent *entry;
+
+	if (dir==NULL)
+		return -1;
+	while ((entry=readdir(dir))!=NULL) {
+		if (strncmp(entry->d_name, name, nameLength)!=0 || entry->d_name[nameLength]!='.'
+		 || sscanf(&entry->d_name[nameLength+1], "%lld%n", &time, &length)!=1
+		 || entry->d_name[nameLength+1+length]!=0 || time>lastEqual || time<=latest)
+			continue;
+		snprintf(fileB, sizeof(fileB), "%s.%lld", simbisectCheckpoints[1], time);
+		if (access(fileB, R_OK)==0)
+			latest=time;
+	}
+	closedir(dir);
+	return latest;
+}
+
+// Removes the hash files and the checkpoints of the runs
+void Simbisect_Clean() {
+	char prefix[32], fileName[512];
+	int prefixLength;
+	DIR *dir=opendir(SIMBISECT_TEMPORARY);
+	struct dirent *entry;
+
+	if (dir==NULL)
+		return;
+	prefixLength=snprintf(prefix, sizeof(prefix), "simbisect.%d.", (int) getpid());
+	while ((entry=readdir(dir))!=NULL)
+		if (strncmp(entry->d_name, prefix, prefixLength)==0) {
+			snprintf(fileName, sizeof(fileName), "%s/%s", SIMBISECT_TEMPORARY, entry->d_name);
+			unlink(fileName);
+		}
+	closedir(dir);
+}
+
+int main(int argc, char *argv[]) {
+	long long lastEqual, firstDifferent, middle, equalTick, differentTick, restoreTime;
+	int interval=1000, first=1, different;
+
+	if (argc>1 && strncmp(argv[1], "--interval=", 11)==0) {
+		interval=atoi(&argv[1][11]);
+		if (interval<1)
+			interval=1000;
+		first++;
+	}
+	if (argc-first!=2) {
+		printf("USE: simbisect hashFileA hashFileB\n     simbisect [--interval=K] \"simulator command A\" \"simulator command B\"\n");
+		return 1;
+	}
+
+	// Two hash files
+	if (strchr(argv[first], ' ')==NULL && strchr(argv[first+1], ' ')==NULL) {
+		if (!Simbisect_Compare(argv[first], argv[first+1], &lastEqual, &firstDifferent)) {
+			printf("Same state hashes\n");
+			return 0;
+		}
+		printf("First different hash at tick %lld (last equal at tick %lld)\n", firstDifferent, lastEqual);
+		return 2;
+	}
+
+	// Two commands
+	snprintf(simbisectFiles[0], sizeof(simbisectFiles[0]), "%s/simbisect.%d.A", SIMBISECT_TEMPORARY, (int) getpid());
+	snprintf(simbisectFiles[1], sizeof(simbisectFiles[1]), "%s/simbisect.%d.B", SIMBISECT_TEMPORARY, (int) getpid());
+	snprintf(simbisectCheckpoints[0], sizeof(simbisectCheckpoints[0]), "%s.checkpoint", simbisectFiles[0]);
+	snprintf(simbisectCheckpoints[1], sizeof(simbisectCheckpoints[1]), "%s.checkpoint", simbisectFiles[1]);
+	Simbisect_Run(argv[first], 0, interval, -1, -1);
+	Simbisect_Run(argv[first+1], 1, interval, -1, -1);
+	different=Simbisect_Compare(simbisectFiles[0], simbisectFiles[1], &lastEqual, &firstDifferent);
+	if (different) {
+		// The hashes of a run up to middle tell in which half they begin to differ: the last
+		// equal one and the first different one are the new ends. Ticks no run can stop at
+		// (the clock goes past them within an instruction) end the search
+		while (firstDifferent-lastEqual>1) {
+			middle=lastEqual+(firstDifferent-lastEqual)/2;
+			restoreTime=Simbisect_Checkpoint(lastEqual);
+			Simbisect_Run(argv[first], 0, interval, middle, restoreTime);
+			Simbisect_Run(argv[first+1], 1, interval, middle, restoreTime);
+			if (!Simbisect_Compare(simbisectFiles[0], simbisectFiles[1], &equalTick, &differentTick))
+				differentTick=firstDifferent;
+			if (differentTick>=firstDifferent && equalTick<=lastEqual)
+				break;
+			if (differentTick<firstDifferent)
+				firstDifferent=differentTick;
+			if (equalTick>lastEqual && equalTick<firstDifferent)
+				lastEqual=equalTick;
+		}
+		printf("Runs differ first at tick %lld\n", firstDifferent);
+	}
+	else
+		printf("Same state hashes\n");
+	Simbisect_Clean();
+	return different ? 2 : 0;
+}
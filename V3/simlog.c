@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include "BinaryLog.h"
+#include "Messages.h"
+
+// simlog: decodes a binary log (Simulator --logFormat=binary) into the text the
+// simulator would have shown, or into CSV rows with one message per row
+//   simlog [--csv] [binaryLogFile]		(standard input by default)
+
+// Rendered text of the current message when writing CSV
+char simlogText[MSGMAXTEXTLENGTH+MSGMAXIMUMLENGTH*BINARYLOG_MAXSTRING];
+int simlogTextLength;
+int simlogCSV=0;
+
+BINARYLOG_RECORD simlogRecord;
+
+// Messages_Write sends the rendered messages here instead of into the log pipeline
+void Log_Write(char section, const char *text, int length) {
+	if (!simlogCSV) {
+		fwrite(text, 1, length, stdout);
+		return;
+	}
+	if (length>(int) sizeof(simlogText)-simlogTextLength)
+		length=sizeof(simlogText)-simlogTextLength;
+	memcpy(&simlogText[simlogTextLength], text, length);
+	simlogTextLength+=length;
+}
+
+int Log_Stream(char section) {
+	return 0;
+}
+
+// Messages_Set does not report anything here
+void ComputerSystem_DebugMessage(int msgNo, char section, ...) {
+}
+
+// Text field with the CSV quoting
+void Simlog_WriteCSVText(const char *text, int length) {
+	int i;
+
+	putchar('"');
+	for (i=0; i<length; i++) {
+		if (text[i]=='"')
+			putchar('"');
+		putchar(text[i]);
+	}
+	putchar('"');
+}
+
+int main(int argc, char *argv[]) {
+	BINARYLOG_READER reader;
+	FILE *input=stdin;
+	int i, type, pos;
+
+	for (i=1; i<argc; i++)
+		if (strcmp(argv[i], "--csv")==0)
+			simlogCSV=1;
+		else if (input==stdin) {
+			input=fopen(argv[i], "rb");
+			if (input==NULL) {
+				printf("Binary log %s cannot be opened\n", argv[i]);
+				return 1;
+			}
+		}
+		else {
+			printf("USE: simlog [--csv] [binaryLogFile]\n");
+			return 1;
+		}
+
+	if (BinaryLog_OpenReader(&reader, input)<0) {
+		printf("Not a binary log of the simulator\n");
+		return 1;
+	}
+	if (simlogCSV)
+		printf("tick,pid,section,message,text\n");
+	while ((type=BinaryLog_Read(&reader, &simlogRecord))>0) {
+		switch (type) {
+			case BINARYLOG_MESSAGE:
+				pos=Messages_Get_Pos(simlogRecord.messageNumber);
+				simlogTextLength=0;
+				Messages_Write(pos, simlogCSV ? 0 : simlogRecord.coloured, simlogRecord.args, simlogRecord.section);
+				if (simlogCSV) {
+					printf("%lld,%d,%c,%d,", simlogRecord.tick, simlogRecord.PID, simlogRecord.section, simlogRecord.messageNumber);
+					Simlog_WriteCSVText(simlogText, simlogTextLength);
+					putchar('\n');
+				}
+				break;
+			case BINARYLOG_TEXT:
+				if (simlogCSV) {
+					printf("%lld,,%c,,", reader.tick, simlogRecord.section);
+					Simlog_WriteCSVText(simlogRecord.text, simlogRecord.textLength);
+					putchar('\n');
+				}
+				else
+					fwrite(simlogRecord.text, 1, simlogRecord.textLength, stdout);
+				break;
+		}
+	}
+	if (input!=stdin)
+		fclose(input);
+	if (type<0) {
+		fflush(stdout);
+		fprintf(stderr, "Binary log truncated or corrupted\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/wait.h>
+
+// simreplay: validates a simulator against the periodic checkpoints of a reference run
+// (--checkpointInterval, files checkpointFile.<time>). Every segment between two
+// consecutive checkpoints is run at the same time as the others, on its own process:
+// restored from the first checkpoint (--restore) up to the time of the second one,
+// whose state has to be the same (--verifyCheckpoint)
+//   simreplay [--jobs=N] checkpointFile "simulator command"
+// The command is the simulator and its options; the replay options are inserted after
+// the first word. N is the number of processors by default
+
+#define SIMREPLAY_COMMANDLENGTH 4096
+#define SIMREPLAY_MAXCHECKPOINTS 4096
+
+// Results of a segment
+enum SimreplayResults { SIMREPLAY_PENDING, SIMREPLAY_SAME, SIMREPLAY_DIFFERENT, SIMREPLAY_FAILED };
+char *simreplayResults[]={"pending", "same", "different", "failed"};
+
+typedef struct {
+	long long time;
+	char fileName[256];
+} CHECKPOINT;
+
+CHECKPOINT checkpoints[SIMREPLAY_MAXCHECKPOINTS];
+int numberOfCheckpoints=0;
+
+// Segment i goes from checkpoint i to checkpoint i+1
+int segmentResults[SIMREPLAY_MAXCHECKPOINTS];
+int segmentPIDs[SIMREPLAY_MAXCHECKPOINTS];
+
+int Simreplay_CompareCheckpoints(const void *a, const void *b) {
+	long long timeA=((CHECKPOINT *) a)->time, timeB=((CHECKPOINT *) b)->time;
+
+	return timeA<timeB ? -1 : timeA>timeB;
+}
+
+// Finds the files prefix.<time> of the directory of prefix
+void Simreplay_FindCheckpoints(char *prefix) {
+	char directory[256], *base;
+	int baseLength, length;
+	DIR *dir;
+	struct dirent *entry;
+	long long time;
+
+	base=strrchr(prefix, '/');
+	if (base==NULL) {
+		strcpy(directory, ".");
+		base=prefix;
+	}
+	else {
+		snprintf(directory, sizeof(directory), "%.*s", (int) (base-prefix), prefix);
+		if (directory[0]==0)
+			strcpy(directory, "/");
+		base++;
+	}
+	baseLength=strlen(base);
+	dir=opendir(directory);
+	if (dir==NULL) {
+		printf("Directory %s cannot be read\n", directory);
+		exit(1);
+	}
+	while ((entry=readdir(dir))!=NULL && numberOfCheckpoints<SIMREPLAY_MAXCHECKPOINTS) {
+		if (strncmp(entry->d_name, base, baseLength)!=0 || entry->d_name[baseLength]!='.'
+		 || sscanf(&entry->d_name[baseLength+1], "%lld%n", &time, &length)!=1
+		 || entry->d_name[baseLength+1+length]!=0)
+			continue;
+		checkpoints[numberOfCheckpoints].time=time;
+		snprintf(checkpoints[numberOfCheckpoints].fileName, sizeof(checkpoints[0].fileName), "%s.%lld", prefix, time);
+		numberOfCheckpoints++;
+	}
+	closedir(dir);
+	qsort(checkpoints, numberOfCheckpoints, sizeof(CHECKPOINT), Simreplay_CompareCheckpoints);
+}
+
+// Runs a segment in a new process. Returns its PID
+int Simreplay_Start(char *command, int segment) {
+	char line[SIMREPLAY_COMMANDLENGTH];
+	int program=strcspn(command, " ");
+	int pid, status;
+
+	snprintf(line, sizeof(line), "%.*s --restore=%s --verifyCheckpoint=%s --logSink=null%s > /dev/null 2>&1",
+		program, command, checkpoints[segment].fileName, checkpoints[segment+1].fileName, &command[program]);
+	pid=fork();
+	if (pid==0) {
+		status=system(line);
+		exit(status==-1 || !WIFEXITED(status) ? 127 : WEXITSTATUS(status));
+	}
+	if (pid<0) {
+		printf("%s cannot be run\n", command);
+		exit(1);
+	}
+	return pid;
+}
+
+// Waits for any segment to end
+void Simreplay_Wait(int numberOfSegments) {
+	int pid, status, segment;
+
+	pid=wait(&status);
+	for (segment=0; segment<numberOfSegments; segment++)
+		if (segmentPIDs[segment]==pid) {
+			if (!WIFEXITED(status) || (WEXITSTATUS(status)!=0 && WEXITSTATUS(status)!=2))
+				segmentResults[segment]=SIMREPLAY_FAILED;
+			else
+				segmentResults[segment]=WEXITSTATUS(status)==0 ? SIMREPLAY_SAME : SIMREPLAY_DIFFERENT;
+			segmentPIDs[segment]=0;
+		}
+}
+
+int main(int argc, char *argv[]) {
+	int jobs=sysconf(_SC_NPROCESSORS_ONLN), first=1, running=0;
+	int segment, numberOfSegments, firstWrong=-1;
+
+	if (argc>1 && strncmp(argv[1], "--jobs=", 7)==0) {
+		jobs=atoi(&argv[1][7]);
+		first++;
+	}
+	if (jobs<1)
+		jobs=1;
+	if (argc-first!=2) {
+		printf("USE: simreplay [--jobs=N] checkpointFile \"simulator command\"\n");
+		return 1;
+	}
+
+	Simreplay_FindCheckpoints(argv[first]);
+	if (numberOfCheckpoints<2) {
+		printf("Less than two checkpoints %s.<time>\n", argv[first]);
+		return 1;
+	}
+	numberOfSegments=numberOfCheckpoints-1;
+
+	for (segment=0; segment<numberOfSegments; segment++) {
+		if (running==jobs) {
+			Simreplay_Wait(numberOfSegments);
+			running--;
+		}
+		segmentPIDs[segment]=Simreplay_Start(argv[first+1], segment);
+		running++;
+	}
+	while (running-->0)
+		Simreplay_Wait(numberOfSegments);
+
+	for (segment=0; segment<numberOfSegments; segment++) {
+		printf("Segment %lld-%lld: %s\n", checkpoints[segment].time, checkpoints[segment+1].time, simreplayResults[segmentResults[segment]]);
+		if (firstWrong<0 && segmentResults[segment]!=SIMREPLAY_SAME)
+			firstWrong=segment;
+	}
+	if (firstWrong<0) {
+		printf("All %d segments are the same\n", numberOfSegments);
+		return 0;
+	}
+	printf("First diverging segment: %lld-%lld\n", checkpoints[firstWrong].time, checkpoints[firstWrong+1].time);
+	return 2;
+}
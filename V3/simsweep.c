@@ -0,0 +1,374 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// simsweep: runs the simulator over a grid of option values, on as many processes at
+// the same time as processors, and writes the metrics of every run (--metricsFile) into
+// one CSV followed by their mean and 95% confidence interval for every configuration
+//   simsweep [--jobs=N] [--seeds=S] [--jitter=J] [--random=K] [--output=file]
+//            simulator [option=value1,value2,...] ... -- program [arrivalTime] ...
+// A configuration is a value of every option: all of them, or K of them at random.
+// Every one is run with the workload of seeds 1 to S (1 by default): seed s moves the
+// arrival time of every program up to J ticks (0 by default) either way. A value "-"
+// leaves the option out and an empty one gives it without value ("tickless=-,")
+
+#define SIMSWEEP_MAXOPTIONS 16
+#define SIMSWEEP_MAXVALUES 32
+#define SIMSWEEP_MAXPROGRAMS 20
+#define SIMSWEEP_MAXARGUMENTS (SIMSWEEP_MAXOPTIONS+2*SIMSWEEP_MAXPROGRAMS+8)
+#define SIMSWEEP_MAXRUNS 100000
+
+// Metrics of a run: the system totals of the report and the averages of the user processes
+enum SimsweepMetrics { SIMSWEEP_TOTALTICKS, SIMSWEEP_CPUUTILIZATION, SIMSWEEP_IDLERATIO, SIMSWEEP_CONTEXTSWITCHES,
+	SIMSWEEP_TURNAROUND, SIMSWEEP_RESPONSE, SIMSWEEP_WAITING, SIMSWEEP_METRICS };
+char *simsweepMetrics[]={"totalTicks", "cpuUtilization", "idleRatio", "contextSwitches",
+	"averageTurnaround", "averageResponse", "averageWaiting"};
+
+// Results of a run
+enum SimsweepResults { SIMSWEEP_PENDING, SIMSWEEP_OK, SIMSWEEP_FAILED };
+char *simsweepResults[]={"pending", "ok", "failed"};
+
+typedef struct {
+	char *name;
+	int numberOfValues;
+	char *values[SIMSWEEP_MAXVALUES];
+} SWEEP_OPTION;
+
+typedef struct {
+	char *name;
+	long long arrivalTime;
+} SWEEP_PROGRAM;
+
+typedef struct {
+	long long configuration;
+	int seed;
+	int pid;
+	int result;
+	double metrics[SIMSWEEP_METRICS];
+} SWEEP_RUN;
+
+SWEEP_OPTION sweepOptions[SIMSWEEP_MAXOPTIONS];
+int numberOfOptions=0;
+SWEEP_PROGRAM sweepPrograms[SIMSWEEP_MAXPROGRAMS];
+int numberOfPrograms=0;
+SWEEP_RUN *sweepRuns;
+int numberOfRuns=0;
+
+char *simulator;
+int seeds=1, jitter=0;
+
+// 95% two-sided quantiles of Student's t for 1 to 30 degrees of freedom
+double simsweepT95[]={12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+	2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+	2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+// xorshift64*, the same sequence on every host
+unsigned long long Simsweep_Random(unsigned long long *state) {
+	*state^=*state>>12;
+	*state^=*state<<25;
+	*state^=*state>>27;
+	return *state*0x2545F4914F6CDD1DULL;
+}
+
+// Value of an option in a configuration (mixed radix, the first option the fastest)
+char *Simsweep_Value(long long configuration, int option) {
+	int i;
+
+	for (i=0; i<option; i++)
+		configuration/=sweepOptions[i].numberOfValues;
+	return sweepOptions[option].values[configuration%sweepOptions[option].numberOfValues];
+}
+
+// Name of the metrics file of a run
+void Simsweep_MetricsFile(int run, char *fileName, size_t size) {
+	snprintf(fileName, size, "/tmp/simsweep.%d.%d.csv", (int) getpid(), run);
+}
+
+// Runs the simulator in a new process. Returns its PID
+int Simsweep_Start(int run) {
+	char *arguments[SIMSWEEP_MAXARGUMENTS];
+	char optionArguments[SIMSWEEP_MAXOPTIONS][256], arrivals[SIMSWEEP_MAXPROGRAMS][24], metricsOption[128];
+	char metricsFile[96];
+	unsigned long long state=0x9E3779B97F4A7C15ULL*(sweepRuns[run].seed+1);
+	long long arrivalTime;
+	int i, numberOfArguments=0, pid, nullFD;
+	char *value;
+
+	Simsweep_MetricsFile(run, metricsFile, sizeof(metricsFile));
+	snprintf(metricsOption, sizeof(metricsOption), "--metricsFile=%s", metricsFile);
+	arguments[numberOfArguments++]=simulator;
+	arguments[numberOfArguments++]="--logSink=null";
+	arguments[numberOfArguments++]=metricsOption;
+	for (i=0; i<numberOfOptions; i++) {
+		value=Simsweep_Value(sweepRuns[run].configuration, i);
+		if (strcmp(value, "-")==0)
+			continue;
+		if (value[0]==0)
+			snprintf(optionArguments[i], sizeof(optionArguments[i]), "--%s", sweepOptions[i].name);
+		else
+			snprintf(optionArguments[i], sizeof(optionArguments[i]), "--%s=%s", sweepOptions[i].name, value);
+		arguments[numberOfArguments++]=optionArguments[i];
+	}
+	for (i=0; i<numberOfPrograms; i++) {
+		arrivalTime=sweepPrograms[i].arrivalTime;
+		if (jitter>0) {
+			arrivalTime+=(long long) (Simsweep_Random(&state)%(2*jitter+1))-jitter;
+			if (arrivalTime<0)
+				arrivalTime=0;
+		}
+		snprintf(arrivals[i], sizeof(arrivals[i]), "%lld", arrivalTime);
+		arguments[numberOfArguments++]=sweepPrograms[i].name;
+		arguments[numberOfArguments++]=arrivals[i];
+	}
+	arguments[numberOfArguments]=NULL;
+
+	pid=fork();
+	if (pid==0) {
+		nullFD=open("/dev/null", O_WRONLY);
+		dup2(nullFD, STDOUT_FILENO);
+		dup2(nullFD, STDERR_FILENO);
+		execvp(simulator, arguments);
+		_exit(127);
+	}
+	if (pid<0) {
+		printf("%s cannot be run\n", simulator);
+		exit(1);
+	}
+	return pid;
+}
+
+// Reads the report of a run. Returns 0 if it cannot be read
+int Simsweep_ReadMetrics(char *fileName, double metrics[]) {
+	char line[1024], *fields[20], *field;
+	int numberOfFields, users=0, responses=0, turnarounds=0, system=0;
+	double value;
+	FILE *stream=fopen(fileName, "r");
+
+	if (stream==NULL)
+		return 0;
+	memset(metrics, 0, SIMSWEEP_METRICS*sizeof(double));
+	// The header of the processes
+	if (fgets(line, sizeof(line), stream)==NULL) {
+		fclose(stream);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), stream)!=NULL) {
+		line[strcspn(line, "\r\n")]=0;
+		if (line[0]==0) {
+			system=1;
+			continue;
+		}
+		for (numberOfFields=0, field=strtok(line, ","); field!=NULL && numberOfFields<20; field=strtok(NULL, ","))
+			fields[numberOfFields++]=field;
+		if (system) {
+			if (numberOfFields!=2 || sscanf(fields[1], "%lf", &value)!=1)
+				continue;
+			if (strcmp(fields[0], "totalTicks")==0)
+				metrics[SIMSWEEP_TOTALTICKS]=value;
+			else if (strcmp(fields[0], "cpuUtilization")==0)
+				metrics[SIMSWEEP_CPUUTILIZATION]=value;
+			else if (strcmp(fields[0], "idleRatio")==0)
+				metrics[SIMSWEEP_IDLERATIO]=value;
+			else if (strcmp(fields[0], "contextSwitches")==0)
+				metrics[SIMSWEEP_CONTEXTSWITCHES]=value;
+		}
+		// pid,program,type,... turnaround,response,waiting
+		else if (numberOfFields==18 && strcmp(fields[2], "USER")==0) {
+			users++;
+			metrics[SIMSWEEP_WAITING]+=atof(fields[17]);
+			if (atoll(fields[15])>=0) {
+				turnarounds++;
+				metrics[SIMSWEEP_TURNAROUND]+=atof(fields[15]);
+			}
+			if (atoll(fields[16])>=0) {
+				responses++;
+				metrics[SIMSWEEP_RESPONSE]+=atof(fields[16]);
+			}
+		}
+	}
+	fclose(stream);
+	if (users>0)
+		metrics[SIMSWEEP_WAITING]/=users;
+	if (turnarounds>0)
+		metrics[SIMSWEEP_TURNAROUND]/=turnarounds;
+	if (responses>0)
+		metrics[SIMSWEEP_RESPONSE]/=responses;
+	return system;
+}
+
+// Waits for any run to end
+void Simsweep_Wait() {
+	char metricsFile[96];
+	int pid, status, run;
+
+	pid=wait(&status);
+	for (run=0; run<numberOfRuns; run++)
+		if (sweepRuns[run].pid==pid) {
+			Simsweep_MetricsFile(run, metricsFile, sizeof(metricsFile));
+			if (WIFEXITED(status) && WEXITSTATUS(status)!=127 && Simsweep_ReadMetrics(metricsFile, sweepRuns[run].metrics))
+				sweepRuns[run].result=SIMSWEEP_OK;
+			else
+				sweepRuns[run].result=SIMSWEEP_FAILED;
+			unlink(metricsFile);
+			sweepRuns[run].pid=0;
+		}
+}
+
+// One line per run and then, per configuration, the mean and the half width of the
+// 95% confidence interval of every metric over its seeds
+void Simsweep_Write(FILE *stream) {
+	double sum, sumOfSquares, mean, halfWidth;
+	int i, metric, run, first, n;
+
+	fprintf(stream, "configuration");
+	for (i=0; i<numberOfOptions; i++)
+		fprintf(stream, ",%s", sweepOptions[i].name);
+	fprintf(stream, ",seed,result");
+	for (metric=0; metric<SIMSWEEP_METRICS; metric++)
+		fprintf(stream, ",%s", simsweepMetrics[metric]);
+	fprintf(stream, "\n");
+	for (run=0; run<numberOfRuns; run++) {
+		fprintf(stream, "%lld", sweepRuns[run].configuration);
+		for (i=0; i<numberOfOptions; i++)
+			fprintf(stream, ",%s", Simsweep_Value(sweepRuns[run].configuration, i));
+		fprintf(stream, ",%d,%s", sweepRuns[run].seed, simsweepResults[sweepRuns[run].result]);
+		for (metric=0; metric<SIMSWEEP_METRICS; metric++)
+			fprintf(stream, ",%.4f", sweepRuns[run].metrics[metric]);
+		fprintf(stream, "\n");
+	}
+
+	fprintf(stream, "\nconfiguration");
+	for (i=0; i<numberOfOptions; i++)
+		fprintf(stream, ",%s", sweepOptions[i].name);
+	fprintf(stream, ",runs");
+	for (metric=0; metric<SIMSWEEP_METRICS; metric++)
+		fprintf(stream, ",%s,%sCI95", simsweepMetrics[metric], simsweepMetrics[metric]);
+	fprintf(stream, "\n");
+	// The runs of a configuration are consecutive
+	for (first=0; first<numberOfRuns; first+=seeds) {
+		for (n=0, run=first; run<first+seeds; run++)
+			n+=sweepRuns[run].result==SIMSWEEP_OK;
+		fprintf(stream, "%lld", sweepRuns[first].configuration);
+		for (i=0; i<numberOfOptions; i++)
+			fprintf(stream, ",%s", Simsweep_Value(sweepRuns[first].configuration, i));
+		fprintf(stream, ",%d", n);
+		for (metric=0; metric<SIMSWEEP_METRICS; metric++) {
+			sum=sumOfSquares=0;
+			for (run=first; run<first+seeds; run++)
+				if (sweepRuns[run].result==SIMSWEEP_OK) {
+					sum+=sweepRuns[run].metrics[metric];
+					sumOfSquares+=sweepRuns[run].metrics[metric]*sweepRuns[run].metrics[metric];
+				}
+			mean=n>0 ? sum/n : 0;
+			halfWidth=0;
+			if (n>1)
+				halfWidth=(n-1<=30 ? simsweepT95[n-2] : 1.96)*sqrt(fmax(0, (sumOfSquares-n*mean*mean)/(n-1))/n);
+			fprintf(stream, ",%.4f,%.4f", mean, halfWidth);
+		}
+		fprintf(stream, "\n");
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int jobs=sysconf(_SC_NPROCESSORS_ONLN), i, first=1, running=0, run, seed, failed=0;
+	long long numberOfConfigurations=1, configuration, samples=-1, *chosen;
+	unsigned long long state=0x2545F4914F6CDD1DULL;
+	char *output=NULL, *values, *value;
+	FILE *stream=stdout;
+
+	for (; first<argc && strncmp(argv[first], "--", 2)==0 && argv[first][2]!=0; first++) {
+		if (strncmp(argv[first], "--jobs=", 7)==0)
+			jobs=atoi(&argv[first][7]);
+		else if (strncmp(argv[first], "--seeds=", 8)==0)
+			seeds=atoi(&argv[first][8]);
+		else if (strncmp(argv[first], "--jitter=", 9)==0)
+			jitter=atoi(&argv[first][9]);
+		else if (strncmp(argv[first], "--random=", 9)==0)
+			samples=atoll(&argv[first][9]);
+		else if (strncmp(argv[first], "--output=", 9)==0)
+			output=&argv[first][9];
+		else
+			break;
+	}
+	if (jobs<1)
+		jobs=1;
+	if (seeds<1)
+		seeds=1;
+	if (jitter<0)
+		jitter=0;
+	for (i=first+1; i<argc && strcmp(argv[i], "--")!=0; i++) {
+		values=strchr(argv[i], '=');
+		if (values==NULL || numberOfOptions==SIMSWEEP_MAXOPTIONS)
+			break;
+		*values++=0;
+		sweepOptions[numberOfOptions].name=argv[i];
+		// strsep keeps the empty values
+		while ((value=strsep(&values, ","))!=NULL && sweepOptions[numberOfOptions].numberOfValues<SIMSWEEP_MAXVALUES)
+			sweepOptions[numberOfOptions].values[sweepOptions[numberOfOptions].numberOfValues++]=value;
+		numberOfConfigurations*=sweepOptions[numberOfOptions++].numberOfValues;
+	}
+	if (first>=argc || i>=argc || strcmp(argv[i], "--")!=0 || i+1>=argc) {
+		printf("USE: simsweep [--jobs=N] [--seeds=S] [--jitter=J] [--random=K] [--output=file]\n"
+			"                simulator [option=value1,value2,...] ... -- program [arrivalTime] ...\n");
+		return 1;
+	}
+	simulator=argv[first];
+	for (i++; i<argc && numberOfPrograms<SIMSWEEP_MAXPROGRAMS; numberOfPrograms++) {
+		sweepPrograms[numberOfPrograms].name=argv[i++];
+		sweepPrograms[numberOfPrograms].arrivalTime=0;
+		if (i<argc && sscanf(argv[i], "%lld", &sweepPrograms[numberOfPrograms].arrivalTime)==1)
+			i++;
+	}
+
+	// The configurations to run, all of them or a sample without repetitions
+	if (samples<0 || samples>numberOfConfigurations)
+		samples=numberOfConfigurations;
+	if (samples*seeds>SIMSWEEP_MAXRUNS) {
+		printf("More than %d runs\n", SIMSWEEP_MAXRUNS);
+		return 1;
+	}
+	chosen=(long long *) malloc(samples*sizeof(long long));
+	for (i=0; i<samples; i++) {
+		if (samples==numberOfConfigurations)
+			chosen[i]=i;
+		else
+			do {
+				chosen[i]=Simsweep_Random(&state)%numberOfConfigurations;
+				for (run=0; run<i && chosen[run]!=chosen[i]; run++);
+			} while (run<i);
+	}
+	sweepRuns=(SWEEP_RUN *) calloc(samples*seeds, sizeof(SWEEP_RUN));
+	for (configuration=0; configuration<samples; configuration++)
+		for (seed=1; seed<=seeds; seed++, numberOfRuns++) {
+			sweepRuns[numberOfRuns].configuration=chosen[configuration];
+			sweepRuns[numberOfRuns].seed=seed;
+		}
+
+	for (run=0; run<numberOfRuns; run++) {
+		if (running==jobs) {
+			Simsweep_Wait();
+			running--;
+		}
+		sweepRuns[run].pid=Simsweep_Start(run);
+		running++;
+	}
+	while (running-->0)
+		Simsweep_Wait();
+
+	if (output!=NULL && (stream=fopen(output, "w"))==NULL) {
+		printf("%s cannot be written\n", output);
+		return 1;
+	}
+	Simsweep_Write(stream);
+	if (stream!=stdout)
+		fclose(stream);
+	for (run=0; run<numberOfRuns; run++)
+		failed+=sweepRuns[run].result!=SIMSWEEP_OK;
+	if (failed>0)
+		fprintf(stderr, "%d of %d runs failed\n", failed, numberOfRuns);
+	return failed>0 ? 2 : 0;
+}